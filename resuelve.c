@@ -11,162 +11,278 @@
 #include "stdio.h"
 #include "stdlib.h" 
 #include "string.h"
+#include "limits.h"
 #include "unistd.h"
 #include "math.h"
+#include "time.h"
 
 #include "resuelve.h"
+#include "resuelve_parse.h"
+#include "resuelve_render.h"
+#include "resuelve_animate.h"
+#include "resuelve_watchdog.h"
+#include "resuelve_components.h"
+#include "resuelve_reset.h"
+#include "resuelve_distance.h"
+#include "resuelve_astar.h"
+#include "resuelve_jps.h"
+#include "resuelve_bidirectional.h"
+#include "resuelve_dstar.h"
+#include "resuelve_hpa.h"
+#include "resuelve_landmarks.h"
 
 void resuelve(struct ResuelveCourse *course, struct ResuelveSolver *solver, 
 				char* filename)
 {
-	// create 2d array for map
-	int **map;
+	// create flat array for map
+	RESUELVE_MAP map;
 	
 	// save filename
 	course->filename = filename;
+	course->text = NULL;
+	course->shown = NULL;
+	course->frame = NULL;
+	course->frame_capacity = 0;
+	course->components = NULL;
+	course->touched = NULL;
+	course->touched_count = 0;
+	course->touched_capacity = 0;
+	course->distances = NULL;
+	course->wavefront = NULL;
+	course->jumps = NULL;
+	course->dstar = NULL;
+	course->hpa = NULL;
+	course->landmarks = NULL;
+	course->landmark_count = 0;
+	// no start or finish until the course is loaded with them
+	course->start_x = -1;
+	course->start_y = -1;
+	course->finish_x = -1;
+	course->finish_y = -1;
 	// don't animate path by default
 	solver->animate_path = 0;
+	solver->animate_steps = 1;
+	solver->animate_fast_forward = 0;
+	solver->animation = NULL;
 	// show path by default
 	solver->show_path = 1;
 	// default angle
 	solver->angle = 0;
+	solver->steps = 0;
+	solver->explored = 0;
+	// no budgets, and search for the finish if the solver stalls, by default
+	solver->step_limit = 0;
+	solver->time_limit = 0;
+	solver->fallback = 1;
+	// follow the wall-hugging solver by default
+	solver->method = RESUELVE_GREEDY;
 	
 	// get course size
 	int course_size[2];
+	RESUELVE_STAT_CLEAR (solver);
+	RESUELVE_STAT_START (solver, load_ms);
 	resuelve_get_course_size (course, course_size);
 	
-	// allocate memory for map
-	map = malloc ((course_size[0]) * sizeof (int*));
-	int i = 0;
-	for (i = 0; i < course_size[0]; i++)
+	// save course size to course struct
+	course->size_x = course_size[0];
+	course->size_y = course_size[1];
+	
+	// a course whose map cannot be indexed with an int is not loaded
+	if (course->size_x > INT_MAX - 2 || course->size_y > INT_MAX - 2
+		|| course->size_x + 2 > INT_MAX / (course->size_y + 2))
 	{
-		map[i] = malloc ((course_size[1]) * sizeof (int));
+		printf ("Course is too large\n");
+		course->size_x = 0;
+		course->size_y = 0;
 	}
 	
-	// save course size and map to course struct
-	course->size_x = course_size[0] - 1;
-	course->size_y = course_size[1] - 1;
+	// allocate memory for map as one block of rows, cleared to walls, with a
+	// border of walls one cell wide around the course
+	course->stride = course->size_x + 2;
+	int cells = course->stride * (course->size_y + 2);
+	map = calloc (cells, sizeof (*map));
+	course->neighbors = calloc (cells, sizeof (*course->neighbors));
+	if (map == NULL || course->neighbors == NULL)
+	{
+		// load an empty course instead
+		printf ("Not enough memory for course\n");
+		free (map);
+		free (course->neighbors);
+		course->size_x = 0;
+		course->size_y = 0;
+		course->stride = 2;
+		cells = 4;
+		map = calloc (cells, sizeof (*map));
+		course->neighbors = calloc (cells, sizeof (*course->neighbors));
+	}
 	course->map = map;
 	
 	// load course
 	resuelve_load_course (course);	
+	RESUELVE_STAT_STOP (solver, load_ms);
+}
+
+/* free everything resuelve allocated for the course
+ */
+void resuelve_free_course (struct ResuelveCourse *course)
+{
+	resuelve_release_course_text (course);
+	resuelve_render_reset (course);
+	resuelve_forget_components (course);
+	resuelve_forget_distances (course);
+	resuelve_jps_forget_table (course);
+	resuelve_dstar_forget (course);
+	resuelve_hpa_forget (course);
+	resuelve_landmarks_forget (course);
+	free (course->row_state);
+	free (course->frame);
+	free (course->touched);
+	free (course->neighbors);
+	free (course->map);
+	
+	course->row_state = NULL;
+	course->frame = NULL;
+	course->frame_capacity = 0;
+	course->touched = NULL;
+	course->touched_count = 0;
+	course->touched_capacity = 0;
+	course->neighbors = NULL;
+	course->map = NULL;
 }
 
 /* get the size of given course
  * returns an array where the first element is the x size and the
  * second element is the y size
+ * the file is read once and kept for resuelve_load_course
  */
 void resuelve_get_course_size (struct ResuelveCourse *course, int *course_size)
 {	
-	// open specified file for reading
-	FILE* file = fopen (course->filename, "r");
-	char buffer[1000];
-	
-	// count the number of lines in the file
-	int linecount = 1;
-	while (fgets (buffer, sizeof buffer, file) != NULL)
+	if (course->text == NULL)
 	{
-		linecount++;
+		resuelve_read_course (course);
 	}
-	// save x and y information
-	course_size[0] = strlen (buffer);
-	course_size[1] = linecount;
-	
-	// close file
-	fclose (file);	
+	resuelve_measure_course (course, course_size);
 }
 
 /* load maze into given course struct
  */
 void resuelve_load_course (struct ResuelveCourse *course)
 {
-	// open file for reading
-	FILE* file = fopen (course->filename, "r");
-	char buffer[1000]; 
-	
-	// read file
-	int y = 0;
-	while (fgets (buffer, sizeof buffer, file) != NULL)
+	// read file, unless resuelve_get_course_size already has
+	if (course->text == NULL)
 	{
-		int x = 0;
-		// read each character and save value in array
-		for (x = 0; x < course->size_x; x++)
-		{
-			char contents[1000];
-			sprintf (contents, "%c", buffer[x]);
-			
-			// save course layout in map array
-			if (strcmp (contents, WALL_MARKER) == 0)
-			{
-				course->map[x][y] = WALL;
-			}
-			else if (strcmp (contents, OPEN_MARKER) == 0)
-			{
-				course->map[x][y] = OPEN;
-			}
-			else if (strcmp (contents, START_MARKER) == 0)
-			{
-				course->map[x][y] = START;
-				course->start_x = x;
-				course->start_y = y;
-			}
-			else if (strcmp (contents, FINISH_MARKER) == 0)
-			{
-				course->map[x][y] = FINISH;
-				course->finish_x = x;
-				course->finish_y = y;
-			}
-		}
-		y++;
+		resuelve_read_course (course);
 	}
 	
-	// close file
-	fclose (file);
+	// save course layout in map array, unless the course is large enough
+	// to be mapped and parsed a row at a time as the solver reaches it
+	resuelve_parse_course (course);
+	if (course->row_state == NULL)
+	{
+		resuelve_release_course_text (course);
+		
+		// save which neighbors of each cell are open for the solver
+		resuelve_build_neighbors (course);
+		
+		// label which spaces can reach each other
+		resuelve_label_components (course);
+#ifdef RESUELVE_JPS_TABLE
+		
+		// work out jump point search jumps up front
+		resuelve_jps_build_table (course);
+#endif
+#ifdef RESUELVE_HPA_GRAPH
+		
+		// cut the course into clusters for hierarchical search up front
+		resuelve_hpa_build (course);
+#endif
+#ifdef RESUELVE_LANDMARK_TABLE
+		
+		// measure the distances from landmarks for A* up front
+		resuelve_landmarks_build (course, 0);
+#endif
+	}
 	printf("Course Loaded\n\n");
 }
 
-/* output representation of maze given by 2d array
+/* neighbor mask bits of each kind of cell, in the position of the up bits
+ * walls are neither open nor clear, and visited spaces are open but not clear
  */
-void resuelve_display_course (struct ResuelveCourse *course)
+static const unsigned char resuelve_neighbor_bits[256] =
+{
+	[OPEN] = UP_OPEN | UP_CLEAR,
+	[START] = UP_OPEN | UP_CLEAR,
+	[FINISH] = UP_OPEN | UP_CLEAR,
+	[PATH] = UP_OPEN | UP_CLEAR,
+	[VISITED] = UP_OPEN,
+};
+
+/* calculate neighbor mask of cell x, y from the four cells around it
+ */
+static int resuelve_cell_neighbors (struct ResuelveCourse *course, int x, 
+									int y)
+{
+	// the border of walls keeps every neighbor of a course cell in the map
+	RESUELVE_MAP cell = &RESUELVE_CELL (course, x, y);
+	
+	// the right, down and left bits sit one, two and three places above the 
+	// up bits
+	return resuelve_neighbor_bits[cell[-course->stride]]
+			| resuelve_neighbor_bits[cell[1]] << 1
+			| resuelve_neighbor_bits[cell[course->stride]] << 2
+			| resuelve_neighbor_bits[cell[-1]] << 3;
+}
+
+/* build neighbor mask for every cell in row y of a loaded course
+ */
+void resuelve_build_row_neighbors (struct ResuelveCourse *course, int y)
+{
+	int x;
+	
+	// iterate through columns
+	for (x = 0; x < course->size_x; x++)
+	{
+		RESUELVE_NEIGHBORS (course, x, y) = 
+			resuelve_cell_neighbors (course, x, y);
+	}
+}
+
+/* build neighbor mask for every cell of a loaded course
+ */
+void resuelve_build_neighbors (struct ResuelveCourse *course)
 {
-	int y, x;
+	int y;
 	
 	// iterate through rows
 	for (y = 0; y < course->size_y; y++)
 	{
-		// iterate through columns
-		for (x = 0; x < course->size_x; x++)
-		{
-			// display appropriate character from course map array
-			if (course->map[x][y] == WALL)
-			{
-				printf (WALL_MARKER);
-			}
-			else if (course->map[x][y] == OPEN)
-			{
-				printf (OPEN_MARKER);
-			}
-			else if (course->map[x][y] == START)
-			{
-				printf (START_MARKER);
-			}
-			else if (course->map[x][y] == FINISH)
-			{
-				printf (FINISH_MARKER);
-			}
-			else if (course->map[x][y] == PATH)
-			{
-				printf (PATH_MARKER);
-			}
-			else if (course->map[x][y] == VISITED)
-			{
-				printf (VISITED_MARKER);
-			}
-		}
-		printf ("\n");
+		resuelve_build_row_neighbors (course, y);
 	}
 }
 
+/* refresh neighbor masks of the cells around x, y after it has changed
+ */
+void resuelve_update_neighbors (struct ResuelveCourse *course, int x, int y)
+{
+	int bits = resuelve_neighbor_bits[RESUELVE_CELL (course, x, y)];
+	unsigned char *neighbors = &RESUELVE_NEIGHBORS (course, x, y);
+	int stride = course->stride;
+	
+	// only the bits facing x, y change, so border cells are safe to touch
+	neighbors[-stride] = (neighbors[-stride] & ~(DOWN_OPEN | DOWN_CLEAR))
+							| bits << 2;
+	neighbors[1] = (neighbors[1] & ~(LEFT_OPEN | LEFT_CLEAR)) | bits << 3;
+	neighbors[stride] = (neighbors[stride] & ~(UP_OPEN | UP_CLEAR)) | bits;
+	neighbors[-1] = (neighbors[-1] & ~(RIGHT_OPEN | RIGHT_CLEAR)) | bits << 1;
+}
+
+/* output representation of maze given by 2d array
+ */
+void resuelve_display_course (struct ResuelveCourse *course)
+{
+	resuelve_render_course (course);
+}
+
 /* return 1 if solver has reached finish, 0 if not
  */
 int resuelve_is_finish (struct ResuelveCourse *course, 
@@ -176,57 +292,123 @@ int resuelve_is_finish (struct ResuelveCourse *course,
 	return (solver->x == course->finish_x && solver->y == course->finish_y);
 }
 
+/* return 1 if the start and finish are both cells of the course, so there is
+ * a route to look for between them
+ */
+static int resuelve_has_ends (struct ResuelveCourse *course)
+{
+	return course->start_x >= 0 && course->start_x < course->size_x
+		&& course->start_y >= 0 && course->start_y < course->size_y
+		&& course->finish_x >= 0 && course->finish_x < course->size_x
+		&& course->finish_y >= 0 && course->finish_y < course->size_y;
+}
+
 /* calculate and display a path from start to finish
+ * returns the number of moves made, or RESUELVE_NO_PATH, RESUELVE_STEP_LIMIT,
+ * RESUELVE_TIME_LIMIT or RESUELVE_STALLED if the finish was not reached
  */
-void resuelve_calculate_path (struct ResuelveCourse *course, 
+int resuelve_calculate_path (struct ResuelveCourse *course, 
 								struct ResuelveSolver *solver)
 {
-	int y, x;
-	// iterate through rows
-	for (y = 0; y < course->size_y; y++)
+	struct ResuelveWatchdog watchdog;
+	int status = 0;
+	
+	// hand the solve to the searching solvers if one was chosen
+	switch (solver->method)
 	{
-		// iterate through columns
-		for (x = 0; x < course->size_x; x++)
-		{
-			// save start coordinates
-			if (course->map[x][y] == START)
-			{
-				solver->y = y;
-				solver->x = x;
-				course->map[x][y] = PATH;
-			}
-		}
+		case RESUELVE_ASTAR:
+			return resuelve_calculate_path_astar (course, solver);
+		case RESUELVE_DISTANCE:
+			return resuelve_calculate_path_distance (course, solver);
+		case RESUELVE_JPS:
+			return resuelve_calculate_path_jps (course, solver);
+		case RESUELVE_BIDIRECTIONAL:
+			return resuelve_calculate_path_bidirectional (course, solver);
+		case RESUELVE_DSTAR:
+			return resuelve_calculate_path_dstar (course, solver);
+		case RESUELVE_HPA:
+			return resuelve_calculate_path_hpa (course, solver);
+	}
+	
+	// an empty course, or one missing its start or finish, has no route
+	if (!resuelve_has_ends (course))
+	{
+		printf ("No path\n");
+		return RESUELVE_NO_PATH;
 	}
 	
+	// save start coordinates
+	solver->x = course->start_x;
+	solver->y = course->start_y;
+	solver->steps = 0;
+	solver->explored = 0;
+	RESUELVE_STAT_SOLVE (solver);
+	RESUELVE_STAT_START (solver, solve_ms);
+	
+	// put back cells marked by an earlier solve of the course
+	resuelve_reset_course (course);
+	RESUELVE_TOUCH_ROW (course, solver->y);
+	resuelve_track_cell (course, solver->x, solver->y);
+	RESUELVE_CELL (course, solver->x, solver->y) = PATH;
+	
 	// display maze and start/finish information
-	resuelve_display_course (course);
+	if (solver->show_path)
+	{
+		resuelve_display_course (course);
+	}
 	printf ("Start: %d, %d\n", solver->x, solver->y);
 	printf ("Finish: %d, %d\n\n", course->finish_x, course->finish_y);
 	
+	// no need to walk anywhere if the finish cannot be reached
+	if (!resuelve_connected (course, solver->x, solver->y, 
+								course->finish_x, course->finish_y))
+	{
+		printf ("No path\n");
+		RESUELVE_STAT_STOP (solver, solve_ms);
+		return RESUELVE_NO_PATH;
+	}
+	resuelve_animate_start (course, solver);
+	resuelve_watchdog_start (&watchdog, solver);
+	
 	// move through maze until finish is found
 	while(solver->x != course->finish_x
 			|| solver->y  != course->finish_y)
 	{
-		if (solver->animate_path)
+		// stop once over budget, and search the rest of the way once going
+		// around in circles
+		status = resuelve_watchdog_check (&watchdog, solver);
+		if (status == RESUELVE_STALLED && solver->fallback)
 		{
-			sleep(1);
+			status = resuelve_watchdog_recover (course, solver);
+			break;
 		}
-		if (solver->show_path)
+		if (status != 0)
 		{
+			break;
+		}
+		
+		// animated solves are shown as their moves are replayed
+		if (solver->show_path && solver->animation == NULL)
+		{
+			RESUELVE_STAT_START (solver, display_ms);
 			resuelve_display_course (course);
 			printf("Current: %d, %d\n\n", solver->x, solver->y);
+			RESUELVE_STAT_STOP (solver, display_ms);
 		}
 		
+		// directions without a wall or visited space next to the solver
+		int clear = RESUELVE_NEIGHBORS (course, solver->x, solver->y) & ALL_CLEAR;
+		
 		// blocked in on all four sides, so move away from finish and allow
 		// visited spaces
-		if (resuelve_check_obstacle (course, solver, UP)
-					&& resuelve_check_obstacle (course, solver, RIGHT)
-					&& resuelve_check_obstacle (course, solver, LEFT)
-					&& resuelve_check_obstacle (course, solver, DOWN))
+		if (RESUELVE_STAT_TEST (solver, check_obstacle, clear == 0))
 		{
+			int open = RESUELVE_NEIGHBORS (course, solver->x, solver->y);
+			RESUELVE_STAT (solver, fallbacks);
+			
 			// need to go right, so try to go right
-			if (solver->x < course->finish_x 
-				&& !resuelve_check_wall (course, solver, RIGHT))
+			if (solver->x < course->finish_x
+				&& RESUELVE_STAT_TEST (solver, check_wall, open & RIGHT_OPEN))
 			{
 				resuelve_move (course, solver, RIGHT);
 				if (resuelve_is_finish (course, solver)) 
@@ -237,7 +419,7 @@ void resuelve_calculate_path (struct ResuelveCourse *course,
 			}
 			// need to go left, so try to go left
 			else if (solver->x > course->finish_x
-						&& !resuelve_check_wall (course, solver, LEFT))
+				&& RESUELVE_STAT_TEST (solver, check_wall, open & LEFT_OPEN))
 			{
 				resuelve_move (course, solver, LEFT);
 				if (resuelve_is_finish (course, solver)) 
@@ -248,7 +430,7 @@ void resuelve_calculate_path (struct ResuelveCourse *course,
 			}
 			// need to go down, so try to go down
 			else if (solver->y < course->finish_y
-						&& !resuelve_check_wall (course, solver, DOWN))
+				&& RESUELVE_STAT_TEST (solver, check_wall, open & DOWN_OPEN))
 			{
 				resuelve_move (course, solver, DOWN);
 				if (resuelve_is_finish (course, solver)) 
@@ -259,7 +441,7 @@ void resuelve_calculate_path (struct ResuelveCourse *course,
 			}
 			// need to go up, so try to go up
 			else if (solver->y > course->finish_y
-						&& !resuelve_check_wall (course, solver, UP))
+				&& RESUELVE_STAT_TEST (solver, check_wall, open & UP_OPEN))
 			{
 				resuelve_move (course, solver, UP);
 				if (resuelve_is_finish (course, solver)) 
@@ -271,8 +453,8 @@ void resuelve_calculate_path (struct ResuelveCourse *course,
 		}
 		
 		// need to go right, so try to go right
-		if (solver->x < course->finish_x 
-			&& !resuelve_check_obstacle (course, solver, RIGHT))
+		if (solver->x < course->finish_x
+			&& RESUELVE_STAT_TEST (solver, check_obstacle, clear & RIGHT_CLEAR))
 		{
 			resuelve_move (course, solver, RIGHT);
 			if (resuelve_is_finish (course, solver)) 
@@ -282,7 +464,7 @@ void resuelve_calculate_path (struct ResuelveCourse *course,
 		}
 		// need to go left, so try to go left
 		else if (solver->x > course->finish_x
-					&& !resuelve_check_obstacle (course, solver, LEFT))
+			&& RESUELVE_STAT_TEST (solver, check_obstacle, clear & LEFT_CLEAR))
 		{
 			resuelve_move (course, solver, LEFT);
 			if (resuelve_is_finish (course, solver)) 
@@ -292,17 +474,17 @@ void resuelve_calculate_path (struct ResuelveCourse *course,
 		}
 		// need to go down, so try to go down
 		else if (solver->y < course->finish_y
-					&& !resuelve_check_obstacle (course, solver, DOWN))
+			&& RESUELVE_STAT_TEST (solver, check_obstacle, clear & DOWN_CLEAR))
 		{
 			resuelve_move (course, solver, DOWN);
 			if (resuelve_is_finish (course, solver)) 
 			{
-				break;
+				break; 
 			}
 		}
 		// need to go up, so try to go up
 		else if (solver->y > course->finish_y
-					&& !resuelve_check_obstacle (course, solver, UP))
+			&& RESUELVE_STAT_TEST (solver, check_obstacle, clear & UP_CLEAR))
 		{
 			resuelve_move (course, solver, UP);
 			if (resuelve_is_finish (course, solver)) 
@@ -310,345 +492,442 @@ void resuelve_calculate_path (struct ResuelveCourse *course,
 				break; 
 			}
 		}
-				
-		// can only go left
-		if (resuelve_check_obstacle (course, solver, UP)
-				&& resuelve_check_obstacle (course, solver, DOWN)
-				&& resuelve_check_obstacle (course, solver, RIGHT))
-		{
-			resuelve_move (course, solver, LEFT);
-			continue;
-		}
-		// can only go right
-		else if (resuelve_check_obstacle (course, solver, UP)
-					&& resuelve_check_obstacle (course, solver, DOWN)
-					&& resuelve_check_obstacle (course, solver, LEFT))
-		{
-			resuelve_move (course, solver, RIGHT);
-			continue;
-		}
-		// can only go up
-		else if (resuelve_check_obstacle (course, solver, RIGHT)
-					&& resuelve_check_obstacle (course, solver, DOWN)
-					&& resuelve_check_obstacle (course, solver, LEFT))
-		{
-			resuelve_move (course, solver, UP);
-			continue;
-		}
-		// can only go down
-		else if (resuelve_check_obstacle (course, solver, UP)
-					&& resuelve_check_obstacle (course, solver, RIGHT)
-					&& resuelve_check_obstacle (course, solver, LEFT))
-		{
-			resuelve_move (course, solver, DOWN);
-			continue;
-		}
-		// can go left or right
-		else if (resuelve_check_obstacle (course, solver, UP)
-					&& resuelve_check_obstacle (course, solver, DOWN))
-		{
-			if (solver->x < course->finish_x 
-				&& !resuelve_check_obstacle (course, solver, RIGHT))
-			{
-				resuelve_move (course, solver, RIGHT);
-				continue;
-			}
-			else if (!resuelve_check_obstacle (course, solver, LEFT))
-			{
-				resuelve_move (course, solver, LEFT);
-				continue;
-			}
-		}
-		// can only go up or down
-		else if (resuelve_check_obstacle (course, solver, LEFT)
-					&& resuelve_check_obstacle (course, solver, RIGHT))
-		{
-			if (solver->y < course->finish_y
-				&& !resuelve_check_obstacle (course, solver, DOWN))
-			{
-				resuelve_move (course, solver, DOWN);
-				continue;
-			}
-			else if (!resuelve_check_obstacle (course, solver, UP))
-			{
-				resuelve_move (course, solver, UP);
-				continue;
-			}
-		}
-		// can only go left or down
-		else if (resuelve_check_obstacle (course, solver, RIGHT)
-					&& resuelve_check_obstacle (course, solver, UP))
+		
+		// pick a branch from the clear directions around the new position
+		clear = RESUELVE_NEIGHBORS (course, solver->x, solver->y) & ALL_CLEAR;
+		// farther away in the y, so prefer going sideways
+		int sideways = solver->x - course->finish_x 
+						< solver->y - course->finish_y;
+		
+		switch (RESUELVE_STAT_TEST (solver, check_obstacle, clear))
 		{
-			// farther away in the y, so go left
-			if (abs (solver->x - course->finish_x < solver->y - course->finish_y)
-				&& !resuelve_check_obstacle (course, solver, LEFT))
+			// blocked in on all four sides, so back out through a visited 
+			// space, to the left if possible
+			case 0:
 			{
-				resuelve_move (course, solver, LEFT);
-				continue;
-			}
-			else if (!resuelve_check_obstacle (course, solver, DOWN))
-			{
-				resuelve_move (course, solver, DOWN);
-				continue;
+				int open = RESUELVE_NEIGHBORS (course, solver->x, solver->y);
+				RESUELVE_STAT (solver, fallbacks);
+				if (RESUELVE_STAT_TEST (solver, check_wall, open & LEFT_OPEN))
+				{
+					resuelve_move (course, solver, LEFT);
+				}
+				else if (RESUELVE_STAT_TEST (solver, check_wall, 
+												open & RIGHT_OPEN))
+				{
+					resuelve_move (course, solver, RIGHT);
+				}
+				else if (RESUELVE_STAT_TEST (solver, check_wall, 
+												open & UP_OPEN))
+				{
+					resuelve_move (course, solver, UP);
+				}
+				else if (RESUELVE_STAT_TEST (solver, check_wall, 
+												open & DOWN_OPEN))
+				{
+					resuelve_move (course, solver, DOWN);
+				}
+				break;
 			}
-		}
-		// can only go left or up
-		else if (resuelve_check_obstacle (course, solver, RIGHT)
-					&& resuelve_check_obstacle (course, solver, DOWN))
-		{
-			// farther away in the y, so go left
-			if (abs (solver->x - course->finish_x < solver->y - course->finish_y)
-				&& !resuelve_check_obstacle (course, solver, LEFT))
-			{
+			// can only go left
+			case LEFT_CLEAR:
 				resuelve_move (course, solver, LEFT);
-				continue;
-			}
-			else if (!resuelve_check_obstacle (course, solver, UP))
-			{
-				resuelve_move (course, solver, UP);
-				continue;
-			}
-		}
-		// can only go right or down
-		else if (resuelve_check_obstacle (course, solver, LEFT)
-					&& resuelve_check_obstacle (course, solver, UP))
-		{
-			// farther away in the y, so go left
-			if (abs (solver->x - course->finish_x < solver->y - course->finish_y)
-				&& !resuelve_check_obstacle (course, solver, RIGHT))
-			{
-				resuelve_move (course, solver, RIGHT);
-				continue;
-			}
-			else if (!resuelve_check_obstacle (course, solver, DOWN))
-			{
-				resuelve_move (course, solver, DOWN);
-				continue;
-			}
-		}
-		// can only go right or up
-		else if (resuelve_check_obstacle (course, solver, LEFT)
-					&& resuelve_check_obstacle (course, solver, DOWN))
-		{
-			// farther away in the y, so go left
-			if (abs (solver->x - course->finish_x < solver->y - course->finish_y)
-				&& !resuelve_check_obstacle (course, solver, RIGHT))
-			{
+				break;
+			// can only go right
+			case RIGHT_CLEAR:
 				resuelve_move (course, solver, RIGHT);
-				continue;
-			}
-			else if (!resuelve_check_obstacle (course, solver, UP))
-			{
+				break;
+			// can only go up
+			case UP_CLEAR:
 				resuelve_move (course, solver, UP);
-				continue;
-			}
+				break;
+			// can only go down
+			case DOWN_CLEAR:
+				resuelve_move (course, solver, DOWN);
+				break;
+			// can go left or right
+			case LEFT_CLEAR | RIGHT_CLEAR:
+				resuelve_move (course, solver, 
+								solver->x < course->finish_x ? RIGHT : LEFT);
+				break;
+			// can only go up or down
+			case UP_CLEAR | DOWN_CLEAR:
+				resuelve_move (course, solver, 
+								solver->y < course->finish_y ? DOWN : UP);
+				break;
+			// can only go left or down
+			case LEFT_CLEAR | DOWN_CLEAR:
+				resuelve_move (course, solver, sideways ? LEFT : DOWN);
+				break;
+			// can only go left or up
+			case LEFT_CLEAR | UP_CLEAR:
+				resuelve_move (course, solver, sideways ? LEFT : UP);
+				break;
+			// can only go right or down
+			case RIGHT_CLEAR | DOWN_CLEAR:
+				resuelve_move (course, solver, sideways ? RIGHT : DOWN);
+				break;
+			// can only go right or up
+			case RIGHT_CLEAR | UP_CLEAR:
+				resuelve_move (course, solver, sideways ? RIGHT : UP);
+				break;
 		}
 	}
 
+	resuelve_animate_finish (course, solver);
+	if (status != 0)
+	{
+		RESUELVE_STAT_STOP (solver, solve_ms);
+		return status;
+	}
+	
 	// display completed maze
-	resuelve_display_course (course);
+	if (solver->show_path)
+	{
+		resuelve_display_course (course);
+	}
 	printf("Done\n");
+	RESUELVE_STAT_STOP (solver, solve_ms);
+	
+	return solver->steps;
 }
 
 /* move solver 1 unit in given direction
+ * the cell in that direction must not be a wall
  */
 void resuelve_move (struct ResuelveCourse *course, 
 					struct ResuelveSolver *solver, int direction)
 {
 	// mark previous location as visited
-	course->map[solver->x][solver->y] = VISITED;
+	RESUELVE_CELL (course, solver->x, solver->y) = VISITED;
+	resuelve_update_neighbors (course, solver->x, solver->y);
 		
-	// make sure we are contained in maze before moving
-	if (direction == UP && solver->y > 0) 
+	// change appropriate solver coordinate
+	if (direction == UP) 
 	{
-		// change appropriate solver coordinate
 		solver->y--;
 	}
-	else if (direction == DOWN && solver->y < course->size_y)
+	else if (direction == DOWN)
 	{
 		solver->y++;
 	}
-	else if (direction == LEFT && solver->x > 0)
+	else if (direction == LEFT)
 	{
 		solver->x--;
 	}
-	else if (direction == RIGHT && solver->x < course->size_x)
+	else if (direction == RIGHT)
 	{
 		solver->x++;		
 	}
 	
 	// change open marker to path marker to record path
-	course->map[solver->x][solver->y] = PATH;
+	RESUELVE_TOUCH_ROW (course, solver->y);
+	if (RESUELVE_STAT_TEST (solver, check_visited, 
+			RESUELVE_CELL (course, solver->x, solver->y) == VISITED))
+	{
+		RESUELVE_STAT (solver, revisits);
+	}
+	else
+	{
+		solver->explored++;
+		resuelve_track_cell (course, solver->x, solver->y);
+	}
+	RESUELVE_CELL (course, solver->x, solver->y) = PATH;
+	resuelve_update_neighbors (course, solver->x, solver->y);
 
-	// update angle
+	// update angle and count move, along with the turn and drive a robot
+	// would make
+	if (solver->angle != direction)
+	{
+		RESUELVE_STAT (solver, turns);
+	}
+	RESUELVE_STAT (solver, drives);
+	RESUELVE_STAT (solver, moves);
 	solver->angle = direction;
+	solver->steps++;
+
+	// let the animation know about the move
+	if (solver->animation != NULL)
+	{
+		resuelve_animate_record (course, solver);
+	}
 }
 
-/* check for wall or visited space in given direction from the current solver 
- * position
- * return 1 if obstacle is found, 0 if path is clear
+/* move solver along a precomputed route, one direction per step
  */
-int resuelve_check_obstacle (struct ResuelveCourse *course, 
-								struct ResuelveSolver *solver, int direction)
+void resuelve_follow_route (struct ResuelveCourse *course, 
+							struct ResuelveSolver *solver, int *route, int length)
 {
-	if (direction == UP) 
+	int i;
+	for (i = 0; i < length; i++)
 	{
-		// make sure we are contained in maze
-		if (solver->y > 0)
+		// animated solves are shown as their moves are replayed
+		if (solver->show_path && solver->animation == NULL)
 		{
-			// check for presence of a wall or a visited space
-			return (course->map[solver->x][solver->y - 1] == WALL)
-					|| (course->map[solver->x][solver->y - 1] == VISITED);
+			RESUELVE_STAT_START (solver, display_ms);
+			resuelve_display_course (course);
+			printf("Current: %d, %d\n\n", solver->x, solver->y);
+			RESUELVE_STAT_STOP (solver, display_ms);
 		}
+		resuelve_move (course, solver, route[i]);
 	}
-	else if (direction == DOWN)
+}
+
+/* move the solver from start to finish along the route find_route gives
+ * from the start, showing the course before and after
+ * returns the number of moves made, or RESUELVE_NO_PATH, RESUELVE_STEP_LIMIT
+ * or RESUELVE_TIME_LIMIT if the finish was not reached
+ */
+int resuelve_solve_route (struct ResuelveCourse *course, 
+							struct ResuelveSolver *solver,
+							int (*find_route) (struct ResuelveCourse*, int, int, 
+												int**))
+{
+	// an empty course, or one missing its start or finish, has no route
+	if (!resuelve_has_ends (course))
 	{
-		if (solver->y < course->size_y)
-		{
-			return (course->map[solver->x][solver->y + 1] == WALL)
-					|| (course->map[solver->x][solver->y + 1] == VISITED);
-		}
+		printf ("No path\n");
+		return RESUELVE_NO_PATH;
 	}
-	else if (direction == LEFT)
+	
+	// save start coordinates
+	solver->x = course->start_x;
+	solver->y = course->start_y;
+	solver->steps = 0;
+	RESUELVE_STAT_SOLVE (solver);
+	RESUELVE_STAT_START (solver, solve_ms);
+	
+	// put back cells marked by an earlier solve of the course
+	resuelve_reset_course (course);
+	RESUELVE_TOUCH_ROW (course, solver->y);
+	resuelve_track_cell (course, solver->x, solver->y);
+	RESUELVE_CELL (course, solver->x, solver->y) = PATH;
+	
+	// display maze and start/finish information
+	if (solver->show_path)
 	{
-		if (solver->x > 0)
-		{
-			return (course->map[solver->x - 1][solver->y] == WALL)
-					|| (course->map[solver->x - 1][solver->y] == VISITED);
-		}
+		resuelve_display_course (course);
 	}
-	else if (direction == RIGHT)
+	printf ("Start: %d, %d\n", solver->x, solver->y);
+	printf ("Finish: %d, %d\n\n", course->finish_x, course->finish_y);
+	
+	int *route;
+	int status = 0;
+	double started = resuelve_clock ();
+	int length = find_route (course, solver->x, solver->y, &route);
+	if (length == RESUELVE_NO_PATH)
 	{
-		if (solver->x < course->size_x)
-		{
-			return (course->map[solver->x + 1][solver->y] == WALL)
-					|| (course->map[solver->x + 1][solver->y] == VISITED);
-		}
+		printf ("No path\n");
+		RESUELVE_STAT_STOP (solver, solve_ms);
+		return RESUELVE_NO_PATH;
 	}
-}
-
-/* check for visited space in given direction from the current solver position
- * return 1 if visited space is found, 0 if path is clear
- */
-int resuelve_check_visited (struct ResuelveCourse *course, 
-							struct ResuelveSolver *solver, int direction)
-{
-	if (direction == UP) 
+	
+	// the search cannot be stopped part way, so stop without moving once
+	// it has run over the time budget, or partway along a route longer
+	// than the step budget
+	if (solver->time_limit > 0 
+		&& resuelve_clock () - started >= solver->time_limit)
 	{
-		// make sure we are contained in maze
-		if (solver->y > 0)
-		{
-			// return 1 if visited above current position, 0 if not
-			return (course->map[solver->x][solver->y - 1] == VISITED);
-		}
+		printf ("Time limit reached\n");
+		status = RESUELVE_TIME_LIMIT;
+		length = 0;
 	}
-	else if (direction == DOWN)
+	else if (solver->step_limit > 0 && length > solver->step_limit)
 	{
-		if (solver->y < course->size_y)
-		{
-			return (course->map[solver->x][solver->y + 1] == VISITED);
-		}
+		printf ("Step limit reached\n");
+		status = RESUELVE_STEP_LIMIT;
+		length = solver->step_limit;
 	}
-	else if (direction == LEFT)
+	
+	// drive the route
+	resuelve_animate_start (course, solver);
+	resuelve_follow_route (course, solver, route, length);
+	free (route);
+	resuelve_animate_finish (course, solver);
+	if (status != 0)
 	{
-		if (solver->x > 0)
-		{
-			return (course->map[solver->x - 1][solver->y] == VISITED);
-		}
+		RESUELVE_STAT_STOP (solver, solve_ms);
+		return status;
 	}
-	else if (direction == RIGHT)
+	
+	// display completed maze
+	if (solver->show_path)
 	{
-		if (solver->x < course->size_x)
-		{
-			return (course->map[solver->x + 1][solver->y] == VISITED);
-		}
+		resuelve_display_course (course);
 	}
+	printf ("Done\n");
+	RESUELVE_STAT_STOP (solver, solve_ms);
+	
+	return length;
 }
 
-/* check for wall in given direction from the current solver position
- * return 1 if wall is found, 0 if path is clear
+/* return neighbor mask clear bit for given direction
  */
-int resuelve_check_wall (struct ResuelveCourse *course, 
-							struct ResuelveSolver *solver, int direction)
+static int resuelve_direction_clear (int direction)
 {
-	if (direction == UP) 
+	switch (direction)
 	{
-		// make sure we are contained in maze
-		if (solver->y > 0)
-		{
-			// return 1 if wall above current position, 0 if not
-			return (course->map[solver->x][solver->y - 1] == WALL);
-		}
-	}
-	else if (direction == DOWN)
-	{
-		if (solver->y < course->size_y)
-		{
-			return (course->map[solver->x][solver->y + 1] == WALL);
-		}
-	}
-	else if (direction == LEFT)
-	{
-		if (solver->x > 0)
-		{
-			return (course->map[solver->x - 1][solver->y] == WALL);
-		}
+		case UP:
+			return UP_CLEAR;
+		case RIGHT:
+			return RIGHT_CLEAR;
+		case DOWN:
+			return DOWN_CLEAR;
+		case LEFT:
+			return LEFT_CLEAR;
 	}
-	else if (direction == RIGHT)
+	return 0;
+}
+
+/* return neighbor mask open bit for given direction
+ */
+static int resuelve_direction_open (int direction)
+{
+	switch (direction)
 	{
-		if (solver->x < course->size_x)
-		{
-			return (course->map[solver->x + 1][solver->y] == WALL);
-		}
+		case UP:
+			return UP_OPEN;
+		case RIGHT:
+			return RIGHT_OPEN;
+		case DOWN:
+			return DOWN_OPEN;
+		case LEFT:
+			return LEFT_OPEN;
 	}
+	return 0;
+}
+
+/* check for wall or visited space in given direction from the current solver 
+ * position
+ * return 1 if obstacle is found, 0 if path is clear
+ */
+int resuelve_check_obstacle (struct ResuelveCourse *course, 
+								struct ResuelveSolver *solver, int direction)
+{
+	RESUELVE_STAT (solver, check_obstacle);
+	return !(RESUELVE_NEIGHBORS (course, solver->x, solver->y) 
+				& resuelve_direction_clear (direction));
+}
+
+/* check for visited space in given direction from the current solver position
+ * return 1 if visited space is found, 0 if path is clear
+ */
+int resuelve_check_visited (struct ResuelveCourse *course, 
+							struct ResuelveSolver *solver, int direction)
+{
+	RESUELVE_STAT (solver, check_visited);
+	int mask = RESUELVE_NEIGHBORS (course, solver->x, solver->y);
+	
+	// visited spaces are open but not clear
+	return (mask & resuelve_direction_open (direction))
+			&& !(mask & resuelve_direction_clear (direction));
+}
+
+/* check for wall in given direction from the current solver position
+ * return 1 if wall is found, 0 if path is clear
+ */
+int resuelve_check_wall (struct ResuelveCourse *course, 
+							struct ResuelveSolver *solver, int direction)
+{
+	RESUELVE_STAT (solver, check_wall);
+	return !(RESUELVE_NEIGHBORS (course, solver->x, solver->y) 
+				& resuelve_direction_open (direction));
 }
 
-void resuelve_set_start (struct ResuelveCourse *course, int start_x, 
+/* move the start of the course to start_x, start_y
+ * returns 0 if the finish can be reached from there, or RESUELVE_NO_PATH
+ */
+int resuelve_set_start (struct ResuelveCourse *course, int start_x, 
 							int start_y)
 {
-	// replace any starts with open space
-	int y, x;
-	// iterate through rows
-	for (y = 0; y < course->size_y; y++)
+	// replace old start with open space
+	RESUELVE_TOUCH_ROW (course, course->start_y);
+	if (RESUELVE_CELL (course, course->start_x, course->start_y) == START)
 	{
-		// iterate through columns
-		for (x = 0; x < course->size_x; x++)
-		{
-			if (course->map[x][y] == START)
-			{
-				course->map[x][y] = OPEN;
-			}
-		}
+		RESUELVE_CELL (course, course->start_x, course->start_y) = OPEN;
 	}
 	
-	// create new start
-	course->map[start_x][start_y] = START;
+	// create new start, which joins components and shortens distances if it
+	// replaces a wall
+	RESUELVE_TOUCH_ROW (course, start_y);
+	if (RESUELVE_CELL (course, start_x, start_y) == WALL)
+	{
+		resuelve_forget_components (course);
+		resuelve_forget_distances (course);
+		resuelve_jps_forget_table (course);
+		resuelve_landmarks_forget (course);
+	}
+	RESUELVE_CELL (course, start_x, start_y) = START;
+	resuelve_update_neighbors (course, start_x, start_y);
+	resuelve_dstar_update_cell (course, start_x, start_y);
+	resuelve_hpa_update_cell (course, start_x, start_y);
 	course->start_x = start_x;
 	course->start_y = start_y;
+	
+	return resuelve_connected (course, start_x, start_y, course->finish_x, 
+								course->finish_y) ? 0 : RESUELVE_NO_PATH;
 }
 
-void resuelve_set_finish (struct ResuelveCourse *course, int finish_x, 
+/* move the finish of the course to finish_x, finish_y
+ * returns 0 if it can be reached from the start, or RESUELVE_NO_PATH
+ */
+int resuelve_set_finish (struct ResuelveCourse *course, int finish_x, 
 							int finish_y)
 {
-	// replace any finishes with open space
-	int y, x;
-	// iterate through rows
-	for (y = 0; y < course->size_y; y++)
+	// replace old finish with open space
+	RESUELVE_TOUCH_ROW (course, course->finish_y);
+	if (RESUELVE_CELL (course, course->finish_x, course->finish_y) == FINISH)
 	{
-		// iterate through columns
-		for (x = 0; x < course->size_x; x++)
-		{
-			if (course->map[x][y] == FINISH)
-			{
-				course->map[x][y] = OPEN;
-			}
-		}
+		RESUELVE_CELL (course, course->finish_x, course->finish_y) = OPEN;
 	}
 	
-	// create new finish
-	course->map[x][y] = FINISH;
+	// create new finish, which joins components if it replaces a wall
+	RESUELVE_TOUCH_ROW (course, finish_y);
+	if (RESUELVE_CELL (course, finish_x, finish_y) == WALL)
+	{
+		resuelve_forget_components (course);
+		resuelve_jps_forget_table (course);
+		resuelve_landmarks_forget (course);
+	}
+	resuelve_forget_distances (course);
+	resuelve_dstar_forget (course);
+	RESUELVE_CELL (course, finish_x, finish_y) = FINISH;
+	resuelve_update_neighbors (course, finish_x, finish_y);
+	resuelve_hpa_update_cell (course, finish_x, finish_y);
 	course->finish_x = finish_x;
 	course->finish_y = finish_y;
+	
+	return resuelve_connected (course, course->start_x, course->start_y, 
+								finish_x, finish_y) ? 0 : RESUELVE_NO_PATH;
+}
+
+/* make cell x, y a wall if wall is set, or an open space if not
+ * cells marked by the last solve are put back first, since the change may
+ * cut through its path; the start and finish cannot be made walls
+ */
+void resuelve_set_wall (struct ResuelveCourse *course, int x, int y, 
+						int wall)
+{
+	resuelve_reset_course (course);
+	RESUELVE_TOUCH_ROW (course, y);
+	
+	int cell = RESUELVE_CELL (course, x, y);
+	if (cell == START || cell == FINISH || (cell == WALL) == (wall != 0))
+	{
+		return;
+	}
+	
+	// components, distances, jumps and landmarks no longer match the walls
+	resuelve_forget_components (course);
+	resuelve_forget_distances (course);
+	resuelve_jps_forget_table (course);
+	resuelve_landmarks_forget (course);
+	RESUELVE_CELL (course, x, y) = wall ? WALL : OPEN;
+	resuelve_update_neighbors (course, x, y);
+	
+	// the search kept for replanning and the clusters around the cell are
+	// repaired instead
+	resuelve_dstar_update_cell (course, x, y);
+	resuelve_hpa_update_cell (course, x, y);
 }
 
 /* set angle for robot
@@ -658,12 +937,31 @@ void resuelve_set_angle (struct ResuelveSolver *solver, int angle)
 	solver->angle = angle;
 }
 
-/* animate path for solver, pausing after every iteration
- * set path_animate to 1 to animate, 0 (default) if not
+/* animate path for solver at rate frames per second, replaying its moves
+ * while it solves at full speed
+ * set rate to 0 (default) to not animate
  */
-void resuelve_set_animate_path (struct ResuelveSolver *solver, int animate)
+void resuelve_set_animate_path (struct ResuelveSolver *solver, int rate)
 {
-	solver->animate_path = animate;
+	solver->animate_path = rate;
+}
+
+/* show steps moves of the solver in each frame of its animation, 1 by
+ * default
+ */
+void resuelve_set_animate_steps (struct ResuelveSolver *solver, int steps)
+{
+	solver->animate_steps = steps > 0 ? steps : 1;
+}
+
+/* skip to the last frame once the solver finishes, instead of replaying
+ * the moves it is ahead of the animation
+ * set fast to 1 to fast forward, 0 (default) if not
+ */
+void resuelve_set_animate_fast_forward (struct ResuelveSolver *solver, 
+										int fast)
+{
+	solver->animate_fast_forward = fast;
 }
 
 /* show map and path of create
@@ -672,3 +970,47 @@ void resuelve_set_show_path (struct ResuelveSolver *solver, int show)
 {
 	solver->show_path = show;
 }
+
+/* stop a solve after steps moves, 0 (default) for no limit
+ */
+void resuelve_set_step_limit (struct ResuelveSolver *solver, int steps)
+{
+	solver->step_limit = steps;
+}
+
+/* stop a solve after limit seconds, 0 (default) for no limit
+ */
+void resuelve_set_time_limit (struct ResuelveSolver *solver, float limit)
+{
+	solver->time_limit = limit;
+}
+
+/* search the rest of the way to the finish when the solver is found going
+ * around in circles
+ * set fallback to 1 (default) to search, 0 to stop the solve instead
+ */
+void resuelve_set_fallback (struct ResuelveSolver *solver, int fallback)
+{
+	solver->fallback = fallback;
+}
+
+/* choose how resuelve_calculate_path solves the course
+ * set method to RESUELVE_GREEDY (default) to follow the walls, or to
+ * RESUELVE_ASTAR, RESUELVE_DISTANCE, RESUELVE_JPS, RESUELVE_BIDIRECTIONAL or
+ * RESUELVE_DSTAR to search for a shortest path and follow it, or to
+ * RESUELVE_HPA to search for a nearly shortest path over clusters of a
+ * very large course
+ */
+void resuelve_set_method (struct ResuelveSolver *solver, int method)
+{
+	solver->method = method;
+}
+
+/* return the current time in seconds
+ */
+double resuelve_clock ()
+{
+	struct timespec now;
+	clock_gettime (CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec / 1e9;
+}
@@ -27,7 +27,52 @@
 #define DOWN 264
 #define LEFT 176
 
-typedef int** RESUELVE_MAP;
+// neighbor mask bits, clear when the neighbor in that direction is neither a
+// wall nor a visited space
+#define UP_CLEAR 1
+#define RIGHT_CLEAR 2
+#define DOWN_CLEAR 4
+#define LEFT_CLEAR 8
+#define ALL_CLEAR 15
+// neighbor mask bits, open when the neighbor in that direction is not a wall
+#define UP_OPEN 16
+#define RIGHT_OPEN 32
+#define DOWN_OPEN 64
+#define LEFT_OPEN 128
+
+// failed solves
+#define RESUELVE_NO_PATH -1
+#define RESUELVE_STEP_LIMIT -2
+#define RESUELVE_TIME_LIMIT -3
+#define RESUELVE_STALLED -4
+
+// ways resuelve_calculate_path can solve a course
+#define RESUELVE_GREEDY 0
+#define RESUELVE_ASTAR 1
+#define RESUELVE_DISTANCE 2
+#define RESUELVE_JPS 3
+#define RESUELVE_BIDIRECTIONAL 4
+#define RESUELVE_DSTAR 5
+#define RESUELVE_HPA 6
+
+// large courses are loaded with a pool of threads unless this is turned off
+#ifndef RESUELVE_NO_THREADS
+#define RESUELVE_THREADS
+#endif
+
+typedef unsigned char* RESUELVE_MAP;
+
+#include "resuelve_stats.h"
+
+// row-major index of cell x, y in the course map, which keeps a border of
+// walls one cell wide around the loaded course
+#define RESUELVE_INDEX(course, x, y) \
+	(((y) + 1) * (course)->stride + (x) + 1)
+// cell x, y of the course map
+#define RESUELVE_CELL(course, x, y) ((course)->map[RESUELVE_INDEX (course, x, y)])
+// neighbor mask of cell x, y
+#define RESUELVE_NEIGHBORS(course, x, y) \
+	((course)->neighbors[RESUELVE_INDEX (course, x, y)])
 
 struct ResuelveSolver
 {
@@ -36,6 +81,18 @@ struct ResuelveSolver
 	int show_path;
 	int animate_path;
 	int angle;
+	int animate_steps;
+	int animate_fast_forward;
+	struct ResuelveAnimation* animation;
+	int steps;
+	int explored;
+	int step_limit;
+	float time_limit;
+	int fallback;
+	int method;
+#ifdef RESUELVE_STATS
+	struct ResuelveStats stats;
+#endif
 };
 
 struct ResuelveCourse
@@ -47,21 +104,63 @@ struct ResuelveCourse
 	int start_y;
 	int finish_x;
 	int finish_y;
-	int** map;
+	int stride;
+	RESUELVE_MAP map;
+	unsigned char* neighbors;
+	char* text;
+	long text_length;
+	int text_mapped;
+	long* row_offsets;
+	unsigned char* row_state;
+	int rows_parsed;
+	RESUELVE_MAP shown;
+	char* frame;
+	long frame_capacity;
+	int* components;
+	int* touched;
+	int touched_count;
+	int touched_capacity;
+	int* distances;
+	struct ResuelveWavefront* wavefront;
+	signed char* jumps;
+	struct ResuelveDstar* dstar;
+	struct ResuelveHpa* hpa;
+	int* landmarks;
+	int landmark_count;
 };
 
 void resuelve (struct ResuelveCourse*, struct ResuelveSolver*, char*);
+void resuelve_free_course (struct ResuelveCourse*);
 void resuelve_get_course_size (struct ResuelveCourse*, int *course_size);
 void resuelve_load_course (struct ResuelveCourse*);
+void resuelve_build_row_neighbors (struct ResuelveCourse*, int);
+void resuelve_build_neighbors (struct ResuelveCourse*);
+void resuelve_update_neighbors (struct ResuelveCourse*, int, int);
 void resuelve_display_course (struct ResuelveCourse*);
-void resuelve_calculate_path (struct ResuelveCourse*, struct ResuelveSolver*);
+int resuelve_calculate_path (struct ResuelveCourse*, struct ResuelveSolver*);
 int resuelve_check_obstacle (struct ResuelveCourse*, struct ResuelveSolver*, int);
 int resuelve_check_wall (struct ResuelveCourse*, struct ResuelveSolver*, int);
 int resuelve_check_visited (struct ResuelveCourse*, struct ResuelveSolver*, int);
 void resuelve_move (struct ResuelveCourse*, struct ResuelveSolver*, int);
-void resuelve_set_start (struct ResuelveCourse*, int, int);
-void resuelve_set_finish (struct ResuelveCourse*, int, int);
+void resuelve_follow_route (struct ResuelveCourse*, struct ResuelveSolver*, int*, int);
+int resuelve_solve_route (struct ResuelveCourse*, struct ResuelveSolver*, int (*) (struct ResuelveCourse*, int, int, int**));
+int resuelve_set_start (struct ResuelveCourse*, int, int);
+int resuelve_set_finish (struct ResuelveCourse*, int, int);
+void resuelve_set_wall (struct ResuelveCourse*, int, int, int);
 void resuelve_set_angle (struct ResuelveSolver*, int);
 void resuelve_set_block_size (struct ResuelveSolver*, float);
 void resuelve_set_animate_path (struct ResuelveSolver*, int);
+void resuelve_set_animate_steps (struct ResuelveSolver*, int);
+void resuelve_set_animate_fast_forward (struct ResuelveSolver*, int);
 void resuelve_set_show_path (struct ResuelveSolver*, int);
+void resuelve_set_step_limit (struct ResuelveSolver*, int);
+void resuelve_set_time_limit (struct ResuelveSolver*, float);
+void resuelve_set_fallback (struct ResuelveSolver*, int);
+void resuelve_set_method (struct ResuelveSolver*, int);
+double resuelve_clock ();
+
+// sharing work among threads, for the modules that load large courses
+#ifdef RESUELVE_THREADS
+int resuelve_thread_count (int, int);
+void resuelve_run_threads (void *(*) (void*), void*, int, size_t);
+#endif
@@ -0,0 +1,186 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#ifndef RESUELVE_CREATE
+#include "time.h"
+#endif
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_animate.h"
+#include "resuelve_parse.h"
+#include "resuelve_render.h"
+
+struct ResuelveAnimation
+{
+	// course as of the last move shown
+	RESUELVE_MAP map;
+	// solver position as of the last move shown
+	int x;
+	int y;
+	// ring buffer of map indices the solver has moved to but not yet shown
+	int moves[RESUELVE_ANIMATE_MOVES];
+	int head;
+	int count;
+	// time the next frame is due, in seconds
+	double next_frame;
+};
+
+/* wait until the time given in seconds
+ */
+static void resuelve_animate_wait (double until)
+{
+	double delay = until - resuelve_clock ();
+	if (delay <= 0)
+	{
+		return;
+	}
+
+#ifdef RESUELVE_CREATE
+	msleep ((long) (delay * 1000));
+#else
+	struct timespec pause;
+	pause.tv_sec = (time_t) delay;
+	pause.tv_nsec = (long) ((delay - pause.tv_sec) * 1e9);
+	nanosleep (&pause, NULL);
+#endif
+}
+
+/* replay up to count recorded moves on the animation's copy of the course
+ */
+static void resuelve_animate_replay (struct ResuelveCourse *course,
+										struct ResuelveAnimation *animation,
+										int count)
+{
+	while (count-- > 0 && animation->count > 0)
+	{
+		int index = animation->moves[animation->head];
+		animation->head = (animation->head + 1) % RESUELVE_ANIMATE_MOVES;
+		animation->count--;
+
+		// same marks resuelve_move leaves
+		animation->map[RESUELVE_INDEX (course, animation->x, animation->y)] = 
+			VISITED;
+		animation->map[index] = PATH;
+		animation->x = index % course->stride - 1;
+		animation->y = index / course->stride - 1;
+	}
+}
+
+/* show the next frame, replaying the solver's next animate_steps moves
+ */
+static void resuelve_animate_frame (struct ResuelveCourse *course,
+									struct ResuelveSolver *solver)
+{
+	struct ResuelveAnimation *animation = solver->animation;
+
+	resuelve_animate_replay (course, animation, solver->animate_steps);
+	resuelve_render_map (course, animation->map);
+	printf ("Current: %d, %d\n\n", animation->x, animation->y);
+
+	// keep to the frame rate, without trying to catch up on a late frame
+	double now = resuelve_clock ();
+	animation->next_frame += 1.0 / solver->animate_path;
+	if (animation->next_frame < now)
+	{
+		animation->next_frame = now;
+	}
+}
+
+/* start animating the solver from its current position, if it is set to
+ * show and animate its path
+ */
+void resuelve_animate_start (struct ResuelveCourse *course, 
+								struct ResuelveSolver *solver)
+{
+	solver->animation = NULL;
+	if (!solver->show_path || solver->animate_path <= 0)
+	{
+		return;
+	}
+
+	struct ResuelveAnimation *animation = 
+		malloc (sizeof (struct ResuelveAnimation));
+	int cells = course->stride * (course->size_y + 2);
+
+	// the animation shows its own copy of the course, which lags the solver
+	resuelve_load_all_rows (course);
+	animation->map = malloc (cells);
+	memcpy (animation->map, course->map, cells);
+	animation->x = solver->x;
+	animation->y = solver->y;
+	animation->head = 0;
+	animation->count = 0;
+	animation->next_frame = resuelve_clock ();
+
+	solver->animation = animation;
+}
+
+/* record the move the solver just made, showing a frame if one is due
+ * only waits for the frame rate once the solver is a full ring buffer ahead
+ */
+void resuelve_animate_record (struct ResuelveCourse *course,
+								struct ResuelveSolver *solver)
+{
+	struct ResuelveAnimation *animation = solver->animation;
+
+	if (animation->count == RESUELVE_ANIMATE_MOVES)
+	{
+		resuelve_animate_wait (animation->next_frame);
+		resuelve_animate_frame (course, solver);
+	}
+
+	int tail = (animation->head + animation->count) % RESUELVE_ANIMATE_MOVES;
+	animation->moves[tail] = RESUELVE_INDEX (course, solver->x, solver->y);
+	animation->count++;
+
+	if (animation->count >= solver->animate_steps 
+		&& resuelve_clock () >= animation->next_frame)
+	{
+		resuelve_animate_frame (course, solver);
+	}
+}
+
+/* show the rest of the recorded moves and stop animating
+ * with animate_fast_forward set they are skipped, and only the last frame
+ * is shown
+ */
+void resuelve_animate_finish (struct ResuelveCourse *course,
+								struct ResuelveSolver *solver)
+{
+	struct ResuelveAnimation *animation = solver->animation;
+	if (animation == NULL)
+	{
+		return;
+	}
+
+	// fast forwarding replays the moves not yet shown all at once, and
+	// shows where they end as one last frame
+	if (solver->animate_fast_forward && animation->count > 0)
+	{
+		resuelve_animate_replay (course, animation, animation->count);
+		resuelve_animate_frame (course, solver);
+	}
+	while (animation->count > 0)
+	{
+		resuelve_animate_wait (animation->next_frame);
+		resuelve_animate_frame (course, solver);
+	}
+
+	free (animation->map);
+	free (animation);
+	solver->animation = NULL;
+}
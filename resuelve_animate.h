@@ -0,0 +1,31 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* animated display of a solve
+ *
+ * the solver runs at full speed and records each move in a ring buffer,
+ * which is replayed animate_steps moves per frame at animate_path frames per
+ * second; the solver only waits when the ring buffer is full
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+
+// moves the solver can get ahead of the animation
+#ifndef RESUELVE_ANIMATE_MOVES
+#define RESUELVE_ANIMATE_MOVES 4096
+#endif
+
+void resuelve_animate_start (struct ResuelveCourse*, struct ResuelveSolver*);
+void resuelve_animate_record (struct ResuelveCourse*, struct ResuelveSolver*);
+void resuelve_animate_finish (struct ResuelveCourse*, struct ResuelveSolver*);
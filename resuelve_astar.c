@@ -0,0 +1,243 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_astar.h"
+#include "resuelve_landmarks.h"
+#include "resuelve_parse.h"
+#include "resuelve_components.h"
+
+// directions in the order neighbors are expanded
+static const int resuelve_astar_directions[4] = { UP, RIGHT, DOWN, LEFT };
+static const int resuelve_astar_dx[4] = { 0, 1, 0, -1 };
+static const int resuelve_astar_dy[4] = { -1, 0, 1, 0 };
+static const int resuelve_astar_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+/* return 1 if node a should leave the open list before node b
+ * ties on f go to the node closer to the finish
+ */
+static int resuelve_astar_before (struct ResuelveAstarNode *a,
+									struct ResuelveAstarNode *b)
+{
+	return (a->f < b->f) || (a->f == b->f && a->h < b->h);
+}
+
+/* return a lower bound on the distance from cell index at x, y to the
+ * finish, raised by the landmarks when the course has them
+ */
+static int resuelve_astar_estimate (struct ResuelveCourse *course, int index,
+									int x, int y, int finish)
+{
+	int h = abs (x - course->finish_x) + abs (y - course->finish_y);
+	if (course->landmarks != NULL)
+	{
+		int bound = resuelve_landmarks_bound (course, index, finish);
+		if (bound > h)
+		{
+			h = bound;
+		}
+	}
+	return h;
+}
+
+/* add node to the open list
+ */
+void resuelve_astar_push (struct ResuelveAstarHeap *heap, int f, int h,
+							int index)
+{
+	// grow heap if full
+	if (heap->count == heap->capacity)
+	{
+		heap->capacity *= 2;
+		heap->nodes = realloc (heap->nodes,
+						heap->capacity * sizeof (struct ResuelveAstarNode));
+	}
+
+	// sift new node up from the bottom of the heap
+	struct ResuelveAstarNode node = { f, h, index };
+	int i = heap->count++;
+	while (i > 0)
+	{
+		int parent = (i - 1) / 2;
+		if (!resuelve_astar_before (&node, &heap->nodes[parent]))
+		{
+			break;
+		}
+		heap->nodes[i] = heap->nodes[parent];
+		i = parent;
+	}
+	heap->nodes[i] = node;
+}
+
+/* remove and return the best node on the open list
+ */
+struct ResuelveAstarNode resuelve_astar_pop (struct ResuelveAstarHeap *heap)
+{
+	struct ResuelveAstarNode top = heap->nodes[0];
+	struct ResuelveAstarNode last = heap->nodes[--heap->count];
+
+	// sift last node down from the top of the heap
+	int i = 0;
+	while (1)
+	{
+		int child = 2 * i + 1;
+		if (child >= heap->count)
+		{
+			break;
+		}
+		if (child + 1 < heap->count
+			&& resuelve_astar_before (&heap->nodes[child + 1],
+										&heap->nodes[child]))
+		{
+			child++;
+		}
+		if (!resuelve_astar_before (&heap->nodes[child], &last))
+		{
+			break;
+		}
+		heap->nodes[i] = heap->nodes[child];
+		i = child;
+	}
+	heap->nodes[i] = last;
+
+	return top;
+}
+
+/* find a shortest route from x, y to the finish of the course
+ * stores a malloc'd array of directions in route and returns its length,
+ * or RESUELVE_NO_PATH if the finish cannot be reached
+ */
+int resuelve_astar_route (struct ResuelveCourse *course, int x, int y,
+							int **route)
+{
+	// search uses map indices, border of walls included
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int finish = RESUELVE_INDEX (course, course->finish_x, course->finish_y);
+	int length = RESUELVE_NO_PATH;
+
+	// offset to the neighbor in each direction
+	int offsets[4] = { -stride, 1, stride, -1 };
+
+	*route = NULL;
+
+	// spaces in different components have no way between them
+	if (!resuelve_connected (course, x, y, course->finish_x, course->finish_y))
+	{
+		return RESUELVE_NO_PATH;
+	}
+#ifdef RESUELVE_LANDMARK_TABLE
+	if (course->landmarks == NULL)
+	{
+		resuelve_landmarks_build (course, 0);
+	}
+#endif
+
+	// cost from start plus one for each cell, 0 until first reached, so
+	// cells the search never reaches are never written
+	int *g = calloc (cells, sizeof (int));
+	// direction index used to enter each cell
+	unsigned char *from = malloc (cells);
+	unsigned char *closed = calloc (cells, 1);
+	int i;
+
+	struct ResuelveAstarHeap open;
+	open.capacity = 64;
+	open.count = 0;
+	open.nodes = malloc (open.capacity * sizeof (struct ResuelveAstarNode));
+
+	// seed open list with starting cell
+	int start = RESUELVE_INDEX (course, x, y);
+	int h = resuelve_astar_estimate (course, start, x, y, finish);
+	g[start] = 1;
+	resuelve_astar_push (&open, h, h, start);
+
+	while (open.count > 0)
+	{
+		struct ResuelveAstarNode node = resuelve_astar_pop (&open);
+
+		// skip stale entries for cells already expanded
+		if (closed[node.index])
+		{
+			continue;
+		}
+		closed[node.index] = 1;
+
+		// finish reached, so walk back through the from directions
+		if (node.index == finish)
+		{
+			length = g[finish] - 1;
+			*route = malloc ((length + 1) * sizeof (int));
+			int cell = finish;
+			for (i = length - 1; i >= 0; i--)
+			{
+				int d = from[cell];
+				(*route)[i] = resuelve_astar_directions[d];
+				cell -= offsets[d];
+			}
+			break;
+		}
+
+		int cx = node.index % stride - 1;
+		int cy = node.index / stride - 1;
+		RESUELVE_TOUCH_ROW (course, cy);
+		int neighbors = course->neighbors[node.index];
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			// skip walls, including the border around the maze
+			if (!(neighbors & resuelve_astar_open[d]))
+			{
+				continue;
+			}
+
+			int nx = cx + resuelve_astar_dx[d];
+			int ny = cy + resuelve_astar_dy[d];
+			int next = node.index + offsets[d];
+			// cost of reaching neighbor through this cell
+			int cost = g[node.index];
+			if (closed[next] || (g[next] != 0 && g[next] <= cost + 1))
+			{
+				continue;
+			}
+
+			// found a shorter way to neighbor
+			g[next] = cost + 1;
+			from[next] = d;
+			h = resuelve_astar_estimate (course, next, nx, ny, finish);
+			resuelve_astar_push (&open, cost + h, h, next);
+		}
+	}
+
+	free (open.nodes);
+	free (closed);
+	free (from);
+	free (g);
+
+	return length;
+}
+
+/* calculate a shortest path from start to finish with A* and move the
+ * solver along it
+ * returns the number of moves made, or RESUELVE_NO_PATH
+ */
+int resuelve_calculate_path_astar (struct ResuelveCourse *course,
+									struct ResuelveSolver *solver)
+{
+	return resuelve_solve_route (course, solver, resuelve_astar_route);
+}
@@ -0,0 +1,41 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* A* search over a loaded course
+ *
+ * the distance left is estimated from landmarks once the course has them,
+ * see resuelve_landmarks.h
+ *
+ * works with either resuelve.h or resuelve_create.h; build this file with
+ * RESUELVE_CREATE defined when linking against resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+
+// entry on the open list, which is a binary heap ordered by f and then h
+struct ResuelveAstarNode
+{
+	int f;
+	int h;
+	int index;
+};
+
+struct ResuelveAstarHeap
+{
+	struct ResuelveAstarNode* nodes;
+	int count;
+	int capacity;
+};
+
+int resuelve_calculate_path_astar (struct ResuelveCourse*, struct ResuelveSolver*);
+int resuelve_astar_route (struct ResuelveCourse*, int, int, int**);
+void resuelve_astar_push (struct ResuelveAstarHeap*, int, int, int);
+struct ResuelveAstarNode resuelve_astar_pop (struct ResuelveAstarHeap*);
@@ -0,0 +1,330 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* time loading, solving and displaying courses
+ *
+ * usage: resuelve_bench [-s solver] [-t seconds] [-r runs] course...
+ *   -s solver   solver to run, greedy, astar, distance, jps, bidirectional,
+ *               dstar or hpa; may be given more than once, default every
+ *               solver
+ *   -t seconds  time each run may take before it is stopped, default 60
+ *   -r runs     runs of each solver on each course, default 1
+ *
+ * each run happens in its own process, so a solver that never finishes or
+ * crashes only loses that run, and peak memory is measured per run
+ * prints one JSON object per run:
+ *   course, solver, run, status ("ok", "no_path", "step_limit",
+ *   "time_limit", "stalled", "no_course", "timeout" or "crashed"),
+ *   size_x, size_y, load_ms (resuelve_get_course_size and
+ *   resuelve_load_course), solve_ms, display_ms, peak_rss_kb, steps,
+ *   visited (cells entered at least once), optimal (shortest path length,
+ *   -1 if there is none) and path_ratio (steps over optimal)
+ *
+ * build with resuelve.c and the shared resuelve_*.c modules, other than the
+ * tools
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "unistd.h"
+#include "fcntl.h"
+#include "signal.h"
+#include "sys/resource.h"
+#include "sys/time.h"
+#include "sys/wait.h"
+
+#include "resuelve.h"
+#include "resuelve_astar.h"
+#include "resuelve_distance.h"
+#include "resuelve_jps.h"
+#include "resuelve_bidirectional.h"
+#include "resuelve_dstar.h"
+#include "resuelve_hpa.h"
+
+// results passed back from the process making a run
+struct ResuelveBenchResult
+{
+	int status;
+	int size_x;
+	int size_y;
+	double load_ms;
+	double solve_ms;
+	double display_ms;
+	long steps;
+	long visited;
+	int optimal;
+};
+
+#define RESUELVE_BENCH_OK 0
+#define RESUELVE_BENCH_NO_COURSE 1
+
+struct ResuelveBenchSolver
+{
+	const char *name;
+	int (*solve) (struct ResuelveCourse*, struct ResuelveSolver*);
+};
+
+static const struct ResuelveBenchSolver resuelve_bench_solvers[] =
+{
+	{ "greedy", resuelve_calculate_path },
+	{ "astar", resuelve_calculate_path_astar },
+	{ "distance", resuelve_calculate_path_distance },
+	{ "jps", resuelve_calculate_path_jps },
+	{ "bidirectional", resuelve_calculate_path_bidirectional },
+	{ "dstar", resuelve_calculate_path_dstar },
+	{ "hpa", resuelve_calculate_path_hpa },
+	{ NULL, NULL }
+};
+
+/* load the course in filename and solve it, saving what was measured in
+ * result
+ */
+static void resuelve_bench_run (char *filename,
+								const struct ResuelveBenchSolver *bench,
+								struct ResuelveBenchResult *result)
+{
+	struct ResuelveCourse course;
+	struct ResuelveSolver solver;
+	double start;
+	int x, y;
+
+	start = resuelve_clock ();
+	resuelve (&course, &solver, filename);
+	result->load_ms = (resuelve_clock () - start) * 1000.0;
+	result->size_x = course.size_x;
+	result->size_y = course.size_y;
+	if (course.size_x == 0 || course.size_y == 0)
+	{
+		result->status = RESUELVE_BENCH_NO_COURSE;
+		result->optimal = RESUELVE_NO_PATH;
+		return;
+	}
+
+	// display is timed on its own, so keep it out of the solve
+	resuelve_set_show_path (&solver, 0);
+	start = resuelve_clock ();
+	int solved = bench->solve (&course, &solver);
+	result->solve_ms = (resuelve_clock () - start) * 1000.0;
+	result->status = solved < 0 ? solved : RESUELVE_BENCH_OK;
+	result->steps = solver.steps;
+
+	start = resuelve_clock ();
+	resuelve_display_course (&course);
+	fflush (stdout);
+	result->display_ms = (resuelve_clock () - start) * 1000.0;
+
+	// every cell the solver entered is left visited, or path where it ended
+	result->visited = 0;
+	for (y = 0; y < course.size_y; y++)
+	{
+		for (x = 0; x < course.size_x; x++)
+		{
+			if (RESUELVE_CELL (&course, x, y) == VISITED
+				|| RESUELVE_CELL (&course, x, y) == PATH)
+			{
+				result->visited++;
+			}
+		}
+	}
+
+	// visited cells are still open, so the shortest path is unchanged
+	int *route;
+	result->optimal = resuelve_astar_route (&course, course.start_x,
+											course.start_y, &route);
+	free (route);
+}
+
+/* return the name reported for a run's status
+ */
+static const char *resuelve_bench_status (int status)
+{
+	switch (status)
+	{
+		case RESUELVE_BENCH_OK:
+			return "ok";
+		case RESUELVE_BENCH_NO_COURSE:
+			return "no_course";
+		case RESUELVE_NO_PATH:
+			return "no_path";
+		case RESUELVE_STEP_LIMIT:
+			return "step_limit";
+		case RESUELVE_TIME_LIMIT:
+			return "time_limit";
+		case RESUELVE_STALLED:
+			return "stalled";
+	}
+	return "failed";
+}
+
+/* print s as a JSON string
+ */
+static void resuelve_bench_string (const char *s)
+{
+	putchar ('"');
+	for (; *s != '\0'; s++)
+	{
+		if (*s == '"' || *s == '\\')
+		{
+			putchar ('\\');
+			putchar (*s);
+		}
+		else if ((unsigned char) *s < 0x20)
+		{
+			printf ("\\u%04x", *s);
+		}
+		else
+		{
+			putchar (*s);
+		}
+	}
+	putchar ('"');
+}
+
+/* make one run in its own process and print its results
+ */
+static void resuelve_bench_fork (char *filename,
+									const struct ResuelveBenchSolver *bench,
+									int run, int limit)
+{
+	struct ResuelveBenchResult result;
+	const char *status = "crashed";
+	struct rusage usage;
+	int pipes[2];
+	int wait_status;
+
+	memset (&result, 0, sizeof (result));
+	fflush (stdout);
+	if (pipe (pipes) != 0)
+	{
+		return;
+	}
+
+	pid_t child = fork ();
+	if (child == 0)
+	{
+		// solver and display output is not part of the report
+		int null = open ("/dev/null", O_WRONLY);
+		dup2 (null, STDOUT_FILENO);
+		close (pipes[0]);
+		alarm (limit);
+
+		resuelve_bench_run (filename, bench, &result);
+		if (write (pipes[1], &result, sizeof (result)) != sizeof (result))
+		{
+			_exit (1);
+		}
+		_exit (0);
+	}
+	close (pipes[1]);
+	if (child < 0)
+	{
+		close (pipes[0]);
+		return;
+	}
+
+	int got = read (pipes[0], &result, sizeof (result)) == sizeof (result);
+	close (pipes[0]);
+	wait4 (child, &wait_status, 0, &usage);
+
+	if (got)
+	{
+		status = resuelve_bench_status (result.status);
+	}
+	else if (WIFSIGNALED (wait_status) && WTERMSIG (wait_status) == SIGALRM)
+	{
+		status = "timeout";
+	}
+
+	printf ("{\"course\": ");
+	resuelve_bench_string (filename);
+	printf (", \"solver\": \"%s\", \"run\": %d, \"status\": \"%s\", "
+			"\"size_x\": %d, \"size_y\": %d, "
+			"\"load_ms\": %.3f, \"solve_ms\": %.3f, \"display_ms\": %.3f, "
+			"\"peak_rss_kb\": %ld, \"steps\": %ld, \"visited\": %ld, "
+			"\"optimal\": %d, \"path_ratio\": %.4f}\n",
+			bench->name, run, status, result.size_x, result.size_y,
+			result.load_ms, result.solve_ms, result.display_ms,
+			usage.ru_maxrss, result.steps, result.visited,
+			got ? result.optimal : -1,
+			got && result.optimal > 0
+				? (double) result.steps / result.optimal : 0.0);
+	fflush (stdout);
+}
+
+int main (int argc, char **argv)
+{
+	int chosen[sizeof (resuelve_bench_solvers)
+				/ sizeof (resuelve_bench_solvers[0])];
+	int any_chosen = 0;
+	int limit = 60;
+	int runs = 1;
+	int arg = 1;
+	int i, run;
+
+	memset (chosen, 0, sizeof (chosen));
+	while (argc > arg + 1 && argv[arg][0] == '-')
+	{
+		if (strcmp (argv[arg], "-s") == 0)
+		{
+			for (i = 0; resuelve_bench_solvers[i].name != NULL; i++)
+			{
+				if (strcmp (argv[arg + 1], resuelve_bench_solvers[i].name) == 0)
+				{
+					break;
+				}
+			}
+			if (resuelve_bench_solvers[i].name == NULL)
+			{
+				printf ("Unknown solver %s\n", argv[arg + 1]);
+				return 1;
+			}
+			chosen[i] = 1;
+			any_chosen = 1;
+		}
+		else if (strcmp (argv[arg], "-t") == 0)
+		{
+			limit = atoi (argv[arg + 1]);
+		}
+		else if (strcmp (argv[arg], "-r") == 0)
+		{
+			runs = atoi (argv[arg + 1]);
+		}
+		else
+		{
+			break;
+		}
+		arg += 2;
+	}
+	if (arg >= argc)
+	{
+		printf ("usage: %s [-s solver] [-t seconds] [-r runs] course...\n",
+				argv[0]);
+		return 1;
+	}
+
+	for (; arg < argc; arg++)
+	{
+		for (i = 0; resuelve_bench_solvers[i].name != NULL; i++)
+		{
+			if (any_chosen && !chosen[i])
+			{
+				continue;
+			}
+			for (run = 0; run < runs; run++)
+			{
+				resuelve_bench_fork (argv[arg], &resuelve_bench_solvers[i],
+										run, limit);
+			}
+		}
+	}
+
+	return 0;
+}
@@ -0,0 +1,236 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_bidirectional.h"
+#include "resuelve_parse.h"
+#include "resuelve_components.h"
+
+// directions in the order neighbors are tried
+static const int resuelve_bidirectional_directions[4] = 
+	{ UP, RIGHT, DOWN, LEFT };
+static const int resuelve_bidirectional_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+// one end of the search
+struct ResuelveBidirectionalSide
+{
+	// distance from this end plus one, 0 until reached
+	int* reached;
+	// spaces in the order they were reached, stepping through the shared
+	// queue by step
+	int* queue;
+	int step;
+	int head;
+	int tail;
+	// space on this side where the shortest route found so far crosses
+	int meet;
+};
+
+/* grow side by every space one further from its end, noting routes through
+ * spaces the other side has already reached
+ * spaces reached by one side are never added to the other, so the sides
+ * fit in one queue between them
+ * returns the length of the shortest route through a meeting, or -1 if
+ * the sides have not met
+ */
+static int resuelve_bidirectional_level (struct ResuelveCourse *course,
+									struct ResuelveBidirectionalSide *side,
+									struct ResuelveBidirectionalSide *other)
+{
+	int stride = course->stride;
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int end = side->tail;
+	int best = -1;
+
+	while (side->head < end)
+	{
+		int index = side->queue[side->step * side->head++];
+		RESUELVE_TOUCH_ROW (course, index / stride - 1);
+		int neighbors = course->neighbors[index];
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			int next = index + offsets[d];
+			if (!(neighbors & resuelve_bidirectional_open[d]))
+			{
+				continue;
+			}
+
+			// sides meet, so there is a route through index and next
+			if (other->reached[next] != 0)
+			{
+				int length = side->reached[index] + other->reached[next] - 1;
+				if (best < 0 || length < best)
+				{
+					best = length;
+					side->meet = index;
+					other->meet = next;
+				}
+				continue;
+			}
+
+			if (side->reached[next] == 0)
+			{
+				side->reached[next] = side->reached[index] + 1;
+				side->queue[side->step * side->tail++] = next;
+			}
+		}
+	}
+
+	return best;
+}
+
+/* fill count directions of route, from the end of side back out to cell
+ * index, in order away from the end if outward is set and toward it if not
+ */
+static void resuelve_bidirectional_trace (struct ResuelveCourse *course,
+									struct ResuelveBidirectionalSide *side,
+									int index, int *route, int outward)
+{
+	int stride = course->stride;
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int count = side->reached[index] - 1;
+	int i;
+
+	// every space but the end has a neighbor one closer to it
+	for (i = 0; i < count; i++)
+	{
+		int neighbors = course->neighbors[index];
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			if ((neighbors & resuelve_bidirectional_open[d])
+				&& side->reached[index + offsets[d]] 
+					== side->reached[index] - 1)
+			{
+				break;
+			}
+		}
+		if (outward)
+		{
+			route[count - 1 - i] = 
+				resuelve_bidirectional_directions[(d + 2) & 3];
+		}
+		else
+		{
+			route[i] = resuelve_bidirectional_directions[d];
+		}
+		index += offsets[d];
+	}
+}
+
+/* find a shortest route from x, y to the finish of the course by searching
+ * out from both ends
+ * stores a malloc'd array of directions in route and returns its length,
+ * or RESUELVE_NO_PATH if the finish cannot be reached
+ */
+int resuelve_bidirectional_route (struct ResuelveCourse *course, int x, 
+									int y, int **route)
+{
+	struct ResuelveBidirectionalSide forward;
+	struct ResuelveBidirectionalSide backward;
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int start = RESUELVE_INDEX (course, x, y);
+	int finish = RESUELVE_INDEX (course, course->finish_x, course->finish_y);
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int best = -1;
+	int d;
+
+	*route = NULL;
+
+	// spaces in different components have no way between them
+	if (!resuelve_connected (course, x, y, course->finish_x, course->finish_y))
+	{
+		return RESUELVE_NO_PATH;
+	}
+	if (start == finish)
+	{
+		*route = malloc (sizeof (int));
+		return 0;
+	}
+
+	// forward side fills the queue from the front, backward from the back
+	int *queue = malloc (cells * sizeof (int));
+	forward.reached = calloc (cells, sizeof (int));
+	forward.queue = queue;
+	forward.step = 1;
+	backward.reached = calloc (cells, sizeof (int));
+	backward.queue = queue + cells - 1;
+	backward.step = -1;
+
+	forward.reached[start] = 1;
+	forward.queue[0] = start;
+	forward.head = 0;
+	forward.tail = 1;
+	backward.reached[finish] = 1;
+	backward.queue[0] = finish;
+	backward.head = 0;
+	backward.tail = 1;
+
+	// routes through spaces reached later are no shorter than the best one
+	// met while growing a side by a step, so stop once the sides meet
+	while (best < 0 && forward.head < forward.tail 
+			&& backward.head < backward.tail)
+	{
+		if (forward.tail - forward.head <= backward.tail - backward.head)
+		{
+			best = resuelve_bidirectional_level (course, &forward, &backward);
+		}
+		else
+		{
+			best = resuelve_bidirectional_level (course, &backward, &forward);
+		}
+	}
+
+	if (best >= 0)
+	{
+		// out to the forward meeting space, across, and on to the finish
+		int before = forward.reached[forward.meet] - 1;
+		*route = malloc ((best + 1) * sizeof (int));
+		resuelve_bidirectional_trace (course, &forward, forward.meet, *route,
+										1);
+		for (d = 0; d < 4; d++)
+		{
+			if (forward.meet + offsets[d] == backward.meet)
+			{
+				break;
+			}
+		}
+		(*route)[before] = resuelve_bidirectional_directions[d];
+		resuelve_bidirectional_trace (course, &backward, backward.meet, 
+										*route + before + 1, 0);
+	}
+
+	free (backward.reached);
+	free (forward.reached);
+	free (queue);
+
+	return best >= 0 ? best : RESUELVE_NO_PATH;
+}
+
+/* calculate a shortest path from start to finish by searching out from both
+ * ends and move the solver along it
+ * returns the number of moves made, or RESUELVE_NO_PATH
+ */
+int resuelve_calculate_path_bidirectional (struct ResuelveCourse *course,
+											struct ResuelveSolver *solver)
+{
+	return resuelve_solve_route (course, solver, resuelve_bidirectional_route);
+}
@@ -0,0 +1,27 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+/* breadth first search out from both the start and the finish of a course,
+ * until the two meet
+ *
+ * each step grows whichever side has fewer spaces on its frontier by one
+ * more space of distance; a long corridor is then searched halfway from
+ * each end rather than all the way from one
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+
+int resuelve_bidirectional_route (struct ResuelveCourse*, int, int, int**);
+int resuelve_calculate_path_bidirectional (struct ResuelveCourse*, struct ResuelveSolver*);
@@ -0,0 +1,350 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "limits.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_binary.h"
+#include "resuelve_parse.h"
+
+/* read a little endian number of given byte count
+ */
+static unsigned long resuelve_binary_get (const unsigned char *bytes, 
+											int count)
+{
+	unsigned long value = 0;
+	int i;
+
+	for (i = count - 1; i >= 0; i--)
+	{
+		value = (value << 8) | bytes[i];
+	}
+	return value;
+}
+
+/* write a little endian number of given byte count
+ */
+static void resuelve_binary_put (unsigned char *bytes, unsigned long value, 
+									int count)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		bytes[i] = value & 0xff;
+		value >>= 8;
+	}
+}
+
+/* number of bytes in one row of the uncompressed wall layer
+ */
+static long resuelve_binary_row_bytes (int size_x)
+{
+	return ((size_x + 63) / 64) * 8;
+}
+
+/* return 1 if the text read for course is in the binary format
+ */
+int resuelve_is_binary_course (struct ResuelveCourse *course)
+{
+	return course->text_length >= RESUELVE_BINARY_HEADER
+			&& memcmp (course->text, RESUELVE_BINARY_MAGIC, 4) == 0;
+}
+
+/* get the size of a binary course from its header
+ * unsupported versions, sizes that are out of range or longer than the
+ * wall layer, and a start or finish off the course have a size of 0
+ */
+void resuelve_measure_binary_course (struct ResuelveCourse *course, 
+										int *course_size)
+{
+	const unsigned char *header = (const unsigned char *) course->text;
+
+	course_size[0] = 0;
+	course_size[1] = 0;
+
+	if (resuelve_binary_get (header + 4, 2) != RESUELVE_BINARY_VERSION)
+	{
+		printf ("Unsupported course version %lu\n", 
+				resuelve_binary_get (header + 4, 2));
+		return;
+	}
+
+	unsigned long size_x = resuelve_binary_get (header + 8, 4);
+	unsigned long size_y = resuelve_binary_get (header + 12, 4);
+	long length = course->text_length - RESUELVE_BINARY_HEADER;
+
+	// the map, with its border, is indexed with an int
+	if (size_x == 0 || size_y == 0 || size_x > INT_MAX - 2 
+		|| size_y > INT_MAX - 2 || size_x + 2 > INT_MAX / (size_y + 2))
+	{
+		printf ("Course size %lu x %lu is out of range\n", size_x, size_y);
+		return;
+	}
+
+	// a bit layer has every row, and a run-length encoded one at least a run
+	long rows = length / resuelve_binary_row_bytes (size_x);
+	if (resuelve_binary_get (header + 6, 2) & RESUELVE_BINARY_RLE)
+	{
+		rows = length > 0 ? size_y : 0;
+	}
+	if (rows < (long) size_y)
+	{
+		printf ("Course file is truncated\n");
+		return;
+	}
+
+	// the start and finish must be on the course
+	unsigned long start_x = resuelve_binary_get (header + 16, 4);
+	unsigned long start_y = resuelve_binary_get (header + 20, 4);
+	unsigned long finish_x = resuelve_binary_get (header + 24, 4);
+	unsigned long finish_y = resuelve_binary_get (header + 28, 4);
+	if (start_x >= size_x || start_y >= size_y)
+	{
+		printf ("Start %lu, %lu is off the course\n", start_x, start_y);
+		return;
+	}
+	if (finish_x >= size_x || finish_y >= size_y)
+	{
+		printf ("Finish %lu, %lu is off the course\n", finish_x, finish_y);
+		return;
+	}
+
+	course_size[0] = size_x;
+	course_size[1] = size_y;
+}
+
+/* expand a bit-packed wall layer into the course map, 8 cells at a time
+ */
+static void resuelve_parse_binary_bits (struct ResuelveCourse *course, 
+										const unsigned char *bits, long length)
+{
+	// eight cell values for every byte of the wall layer
+	static unsigned char cells[256][8];
+	static int cells_ready = 0;
+	long row_bytes = resuelve_binary_row_bytes (course->size_x);
+	int y, i;
+
+	if (!cells_ready)
+	{
+		for (i = 0; i < 256; i++)
+		{
+			int bit;
+			for (bit = 0; bit < 8; bit++)
+			{
+				cells[i][bit] = (i >> bit) & 1 ? WALL : OPEN;
+			}
+		}
+		cells_ready = 1;
+	}
+
+	for (y = 0; y < course->size_y; y++)
+	{
+		const unsigned char *row = bits + y * row_bytes;
+		RESUELVE_MAP map = &RESUELVE_CELL (course, 0, y);
+		int x;
+
+		// rows past the end of a truncated file stay walls
+		if ((y + 1) * row_bytes > length)
+		{
+			printf ("Course file is truncated\n");
+			break;
+		}
+
+		for (x = 0; x + 8 <= course->size_x; x += 8)
+		{
+			memcpy (map + x, cells[row[x / 8]], 8);
+		}
+		// last few cells of the row
+		for (; x < course->size_x; x++)
+		{
+			map[x] = cells[row[x / 8]][x % 8];
+		}
+	}
+}
+
+/* expand a run-length encoded wall layer into the course map
+ */
+static void resuelve_parse_binary_runs (struct ResuelveCourse *course, 
+										const unsigned char *runs, long length)
+{
+	long cells = (long) course->size_x * course->size_y;
+	long cell = 0;
+	long i = 0;
+	int value = OPEN;
+
+	while (cell < cells && i < length)
+	{
+		// decode one run length
+		unsigned long run = 0;
+		int shift = 0;
+		while (i < length)
+		{
+			run |= (unsigned long) (runs[i] & 0x7f) << shift;
+			shift += 7;
+			if (!(runs[i++] & 0x80))
+			{
+				break;
+			}
+		}
+
+		// fill run, which may continue over several rows
+		while (run > 0 && cell < cells)
+		{
+			int x = cell % course->size_x;
+			int y = cell / course->size_x;
+			long count = course->size_x - x;
+			if (count > (long) run)
+			{
+				count = run;
+			}
+			memset (&RESUELVE_CELL (course, x, y), value, count);
+			cell += count;
+			run -= count;
+		}
+
+		value = (value == OPEN) ? WALL : OPEN;
+	}
+
+	if (cell < cells)
+	{
+		printf ("Course file is truncated\n");
+	}
+}
+
+/* save the binary course held in course->text in the course map, which must
+ * already be allocated for the measured size
+ */
+void resuelve_parse_binary_course (struct ResuelveCourse *course)
+{
+	const unsigned char *header = (const unsigned char *) course->text;
+	const unsigned char *layer = header + RESUELVE_BINARY_HEADER;
+	long length = course->text_length - RESUELVE_BINARY_HEADER;
+
+	if (course->size_x == 0 || course->size_y == 0)
+	{
+		return;
+	}
+
+	course->start_x = resuelve_binary_get (header + 16, 4);
+	course->start_y = resuelve_binary_get (header + 20, 4);
+	course->finish_x = resuelve_binary_get (header + 24, 4);
+	course->finish_y = resuelve_binary_get (header + 28, 4);
+
+	if (resuelve_binary_get (header + 6, 2) & RESUELVE_BINARY_RLE)
+	{
+		resuelve_parse_binary_runs (course, layer, length);
+	}
+	else
+	{
+		resuelve_parse_binary_bits (course, layer, length);
+	}
+
+	// start and finish are kept in the header rather than the wall layer,
+	// and were checked to be on the course when it was measured
+	RESUELVE_CELL (course, course->start_x, course->start_y) = START;
+	RESUELVE_CELL (course, course->finish_x, course->finish_y) = FINISH;
+}
+
+/* write one run length to file
+ */
+static void resuelve_write_binary_run (FILE *file, unsigned long run)
+{
+	while (run >= 0x80)
+	{
+		fputc ((run & 0x7f) | 0x80, file);
+		run >>= 7;
+	}
+	fputc (run, file);
+}
+
+/* save a loaded course to filename in the binary format, run-length encoding
+ * the wall layer if compress is set
+ * returns 1 on success, 0 if the file could not be written
+ */
+int resuelve_write_binary_course (struct ResuelveCourse *course, 
+									char *filename, int compress)
+{
+	unsigned char header[RESUELVE_BINARY_HEADER];
+	int y, x;
+
+	// open specified file for writing
+	FILE* file = fopen (filename, "wb");
+	if (file == NULL)
+	{
+		printf ("Could not open %s\n", filename);
+		return 0;
+	}
+
+	// the whole course is written, so parse any rows not reached yet
+	resuelve_load_all_rows (course);
+
+	memcpy (header, RESUELVE_BINARY_MAGIC, 4);
+	resuelve_binary_put (header + 4, RESUELVE_BINARY_VERSION, 2);
+	resuelve_binary_put (header + 6, compress ? RESUELVE_BINARY_RLE : 0, 2);
+	resuelve_binary_put (header + 8, course->size_x, 4);
+	resuelve_binary_put (header + 12, course->size_y, 4);
+	resuelve_binary_put (header + 16, course->start_x, 4);
+	resuelve_binary_put (header + 20, course->start_y, 4);
+	resuelve_binary_put (header + 24, course->finish_x, 4);
+	resuelve_binary_put (header + 28, course->finish_y, 4);
+	fwrite (header, 1, sizeof header, file);
+
+	if (compress)
+	{
+		// count runs of open and wall cells in row order
+		int value = OPEN;
+		unsigned long run = 0;
+		for (y = 0; y < course->size_y; y++)
+		{
+			for (x = 0; x < course->size_x; x++)
+			{
+				int cell = (RESUELVE_CELL (course, x, y) == WALL) ? WALL : OPEN;
+				if (cell != value)
+				{
+					resuelve_write_binary_run (file, run);
+					value = cell;
+					run = 0;
+				}
+				run++;
+			}
+		}
+		resuelve_write_binary_run (file, run);
+	}
+	else
+	{
+		// pack walls one bit per cell, padding each row to whole words
+		long row_bytes = resuelve_binary_row_bytes (course->size_x);
+		unsigned char *row = malloc (row_bytes);
+		for (y = 0; y < course->size_y; y++)
+		{
+			memset (row, 0, row_bytes);
+			for (x = 0; x < course->size_x; x++)
+			{
+				if (RESUELVE_CELL (course, x, y) == WALL)
+				{
+					row[x / 8] |= 1 << (x % 8);
+				}
+			}
+			fwrite (row, 1, row_bytes, file);
+		}
+		free (row);
+	}
+
+	// close file
+	return fclose (file) == 0;
+}
@@ -0,0 +1,43 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* binary course format
+ *
+ * all numbers are little endian
+ *
+ *   0  magic "RSLV"
+ *   4  16 bit version, RESUELVE_BINARY_VERSION
+ *   6  16 bit flags
+ *   8  32 bit size_x, size_y, start_x, start_y, finish_x, finish_y
+ *  32  wall layer
+ *
+ * the wall layer has one bit per cell, set for walls, least significant bit
+ * first, with each row padded to a whole number of 64 bit words
+ * with RESUELVE_BINARY_RLE set it is instead a list of run lengths over the
+ * cells in row order, alternating open and wall and starting with open, each
+ * stored 7 bits per byte with the high bit set on all but the last byte
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+
+#define RESUELVE_BINARY_MAGIC "RSLV"
+#define RESUELVE_BINARY_VERSION 1
+#define RESUELVE_BINARY_HEADER 32
+
+// flags
+#define RESUELVE_BINARY_RLE 1
+
+int resuelve_is_binary_course (struct ResuelveCourse*);
+void resuelve_measure_binary_course (struct ResuelveCourse*, int *course_size);
+void resuelve_parse_binary_course (struct ResuelveCourse*);
+int resuelve_write_binary_course (struct ResuelveCourse*, char*, int);
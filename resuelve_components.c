@@ -0,0 +1,122 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_components.h"
+#include "resuelve_parse.h"
+
+/* return the label at the root of the tree holding index
+ */
+static int resuelve_component_root (int *components, int index)
+{
+	while (components[index] != index)
+	{
+		// halve the path on the way up
+		components[index] = components[components[index]];
+		index = components[index];
+	}
+	return index;
+}
+
+/* label the connected components of the course's spaces with union-find
+ * over its rows, keeping the labels with the course
+ * each tree is rooted at its smallest index, so one pass in map order
+ * flattens every tree once it is built
+ */
+void resuelve_label_components (struct ResuelveCourse *course)
+{
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int index;
+
+	// every row is needed, so parse any not reached yet
+	resuelve_load_all_rows (course);
+
+	free (course->components);
+	int *components = calloc (cells, sizeof (int));
+	const unsigned char *neighbors = course->neighbors;
+
+	// the border is all walls, so the first space comes after the top row
+	for (index = stride; index < cells - stride; index++)
+	{
+		if (course->map[index] == WALL)
+		{
+			continue;
+		}
+
+		// join the space to the left, then to the one above
+		int mask = neighbors[index];
+		components[index] = (mask & LEFT_OPEN) 
+							? resuelve_component_root (components, index - 1)
+							: index;
+		if (mask & UP_OPEN)
+		{
+			int root = resuelve_component_root (components, index);
+			int above = resuelve_component_root (components, index - stride);
+			if (root < above)
+			{
+				components[above] = root;
+			}
+			else
+			{
+				components[root] = above;
+			}
+		}
+	}
+
+	// roots come before the spaces under them, so each is already final
+	for (index = stride; index < cells - stride; index++)
+	{
+		if (components[index] != 0)
+		{
+			components[index] = components[components[index]];
+		}
+	}
+
+	course->components = components;
+}
+
+/* drop the labels, after a change to the walls, to be made again when next
+ * needed
+ */
+void resuelve_forget_components (struct ResuelveCourse *course)
+{
+	free (course->components);
+	course->components = NULL;
+}
+
+/* return 1 if spaces ax, ay and bx, by are in the same component, 0 if
+ * either is a wall or there is no way between them
+ * labels the course first if it has no labels; a lazily parsed course with
+ * rows not yet parsed is not labelled, since that would parse every row,
+ * and 1 is returned as the spaces may be connected
+ */
+int resuelve_connected (struct ResuelveCourse *course, int ax, int ay, 
+						int bx, int by)
+{
+	if (course->components == NULL)
+	{
+		if (course->row_state != NULL && course->rows_parsed < course->size_y)
+		{
+			return 1;
+		}
+		resuelve_label_components (course);
+	}
+
+	int a = course->components[RESUELVE_INDEX (course, ax, ay)];
+	return a != 0 && a == course->components[RESUELVE_INDEX (course, bx, by)];
+}
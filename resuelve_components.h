@@ -0,0 +1,25 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* connected components of the spaces of a course
+ *
+ * every space is labelled with the map index of the first space of its
+ * component, and walls with 0, so two spaces are connected exactly when
+ * their labels match
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+
+void resuelve_label_components (struct ResuelveCourse*);
+void resuelve_forget_components (struct ResuelveCourse*);
+int resuelve_connected (struct ResuelveCourse*, int, int, int, int);
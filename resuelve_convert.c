@@ -0,0 +1,55 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* convert a course file to the binary course format
+ *
+ * usage: resuelve_convert [-r] input output
+ *   -r  run-length encode the wall layer
+ *
+ * build with resuelve.c and the shared resuelve_*.c modules, other than the
+ * tools
+ */
+
+#include "stdio.h"
+#include "string.h"
+
+#include "resuelve.h"
+#include "resuelve_binary.h"
+
+int main (int argc, char **argv)
+{
+	struct ResuelveCourse course;
+	struct ResuelveSolver solver;
+	int compress = 0;
+	int arg = 1;
+
+	if (argc > arg && strcmp (argv[arg], "-r") == 0)
+	{
+		compress = 1;
+		arg++;
+	}
+	if (argc - arg != 2)
+	{
+		printf ("usage: %s [-r] input output\n", argv[0]);
+		return 1;
+	}
+
+	// load course, text or binary
+	resuelve (&course, &solver, argv[arg]);
+
+	if (!resuelve_write_binary_course (&course, argv[arg + 1], compress))
+	{
+		return 1;
+	}
+	printf ("Wrote %s (%d x %d)\n", argv[arg + 1], course.size_x, 
+			course.size_y);
+
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_distance.h"
+#include "resuelve_wavefront.h"
+#include "resuelve_parse.h"
+
+// courses with at least this many cells are searched over bit rows, which
+// is faster and keeps 3 bits per cell instead of an int
+#ifndef RESUELVE_WAVEFRONT_CELLS
+#define RESUELVE_WAVEFRONT_CELLS (1L << 16)
+#endif
+
+// directions in the order neighbors are tried
+static const int resuelve_distance_directions[4] = { UP, RIGHT, DOWN, LEFT };
+static const int resuelve_distance_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+/* find the distance from every space the finish can be reached from, and
+ * keep them with the course
+ * distances are stored plus one, so walls and spaces with no way to the
+ * finish are left 0
+ */
+void resuelve_measure_distances (struct ResuelveCourse *course)
+{
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int finish = RESUELVE_INDEX (course, course->finish_x, course->finish_y);
+	int head = 0;
+	int tail = 0;
+
+	free (course->distances);
+	int *distances = calloc (cells, sizeof (int));
+	// each space is queued at most once, when it is first reached
+	int *queue = malloc (cells * sizeof (int));
+
+	distances[finish] = 1;
+	queue[tail++] = finish;
+	while (head < tail)
+	{
+		int index = queue[head++];
+		RESUELVE_TOUCH_ROW (course, index / stride - 1);
+		int neighbors = course->neighbors[index];
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			int next = index + offsets[d];
+			if ((neighbors & resuelve_distance_open[d]) && distances[next] == 0)
+			{
+				distances[next] = distances[index] + 1;
+				queue[tail++] = next;
+			}
+		}
+	}
+
+	free (queue);
+	course->distances = distances;
+}
+
+/* drop the distances, after the finish or the walls change, to be found
+ * again when next needed
+ */
+void resuelve_forget_distances (struct ResuelveCourse *course)
+{
+	free (course->distances);
+	course->distances = NULL;
+	resuelve_wavefront_forget (course);
+}
+
+/* find a shortest route from x, y to the finish of the course by following
+ * the distances down, measuring them first if the course has none
+ * large courses are searched with resuelve_wavefront_route instead
+ * stores a malloc'd array of directions in route and returns its length,
+ * or RESUELVE_NO_PATH if the finish cannot be reached
+ */
+int resuelve_distance_route (struct ResuelveCourse *course, int x, int y,
+								int **route)
+{
+	int stride = course->stride;
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int i;
+
+	if ((long) course->size_x * course->size_y >= RESUELVE_WAVEFRONT_CELLS)
+	{
+		return resuelve_wavefront_route (course, x, y, route);
+	}
+
+	*route = NULL;
+	if (course->distances == NULL)
+	{
+		resuelve_measure_distances (course);
+	}
+
+	int index = RESUELVE_INDEX (course, x, y);
+	int length = course->distances[index] - 1;
+	if (length < 0)
+	{
+		return RESUELVE_NO_PATH;
+	}
+
+	// every space but the finish has a neighbor one closer to it
+	*route = malloc ((length + 1) * sizeof (int));
+	for (i = 0; i < length; i++)
+	{
+		int neighbors = course->neighbors[index];
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			if ((neighbors & resuelve_distance_open[d])
+				&& course->distances[index + offsets[d]] 
+					== course->distances[index] - 1)
+			{
+				break;
+			}
+		}
+		(*route)[i] = resuelve_distance_directions[d];
+		index += offsets[d];
+	}
+
+	return length;
+}
+
+/* move the solver from start to finish along a shortest path found from the
+ * distances to the finish
+ * returns the number of moves made, or RESUELVE_NO_PATH
+ */
+int resuelve_calculate_path_distance (struct ResuelveCourse *course,
+										struct ResuelveSolver *solver)
+{
+	return resuelve_solve_route (course, solver, resuelve_distance_route);
+}
@@ -0,0 +1,31 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* distances from every space of a course to its finish, for answering
+ * routes from many starts to the same finish
+ *
+ * the distances are found once with a breadth first search out from the
+ * finish and kept with the course; a route from any space then follows
+ * them downhill, one step per move, without searching again
+ *
+ * large courses keep the search of resuelve_wavefront.h instead, which
+ * loads every row of a lazily parsed course
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+
+void resuelve_measure_distances (struct ResuelveCourse*);
+void resuelve_forget_distances (struct ResuelveCourse*);
+int resuelve_distance_route (struct ResuelveCourse*, int, int, int**);
+int resuelve_calculate_path_distance (struct ResuelveCourse*, struct ResuelveSolver*);
@@ -0,0 +1,441 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_dstar.h"
+#include "resuelve_parse.h"
+#include "resuelve_components.h"
+
+// distance of spaces with no known way to the finish
+#define RESUELVE_DSTAR_FAR (1 << 30)
+
+// directions in the order neighbors are tried
+static const int resuelve_dstar_directions[4] = { UP, RIGHT, DOWN, LEFT };
+static const int resuelve_dstar_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+// entry on the open list, ordered by first and then second key
+struct ResuelveDstarEntry
+{
+	int first;
+	int second;
+	int index;
+};
+
+struct ResuelveDstar
+{
+	// settled distance to the finish of each space, and the distance seen
+	// from its neighbors, which differ until the space is settled again
+	int* g;
+	int* rhs;
+	// place of each space on the open list, or -1 if it is not there
+	int* position;
+	struct ResuelveDstarEntry* open;
+	int count;
+	int capacity;
+	int offsets[4];
+	int stride;
+	int finish;
+	// start the keys were last measured from, and how far the start has
+	// moved since the search began
+	int start;
+	int moved;
+};
+
+/* return the distance from cell a to cell b, ignoring walls
+ */
+static int resuelve_dstar_heuristic (struct ResuelveDstar *dstar, int a, 
+										int b)
+{
+	return abs (a % dstar->stride - b % dstar->stride)
+			+ abs (a / dstar->stride - b / dstar->stride);
+}
+
+/* return 1 if entry a should leave the open list before entry b
+ */
+static int resuelve_dstar_before (struct ResuelveDstarEntry *a,
+									struct ResuelveDstarEntry *b)
+{
+	return a->first < b->first 
+			|| (a->first == b->first && a->second < b->second);
+}
+
+/* measure the keys of cell index into entry
+ */
+static void resuelve_dstar_key (struct ResuelveDstar *dstar, int index,
+								struct ResuelveDstarEntry *entry)
+{
+	int best = dstar->g[index] < dstar->rhs[index] 
+				? dstar->g[index] : dstar->rhs[index];
+	entry->first = best + resuelve_dstar_heuristic (dstar, dstar->start, index)
+					+ dstar->moved;
+	entry->second = best;
+	entry->index = index;
+}
+
+/* put entry at place i of the open list
+ */
+static void resuelve_dstar_place (struct ResuelveDstar *dstar, int i,
+									struct ResuelveDstarEntry entry)
+{
+	dstar->open[i] = entry;
+	dstar->position[entry.index] = i;
+}
+
+/* move the entry at place i of the open list up or down to where its keys
+ * belong
+ */
+static void resuelve_dstar_sift (struct ResuelveDstar *dstar, int i)
+{
+	struct ResuelveDstarEntry entry = dstar->open[i];
+
+	while (i > 0 
+			&& resuelve_dstar_before (&entry, &dstar->open[(i - 1) / 2]))
+	{
+		resuelve_dstar_place (dstar, i, dstar->open[(i - 1) / 2]);
+		i = (i - 1) / 2;
+	}
+	while (1)
+	{
+		int child = 2 * i + 1;
+		if (child >= dstar->count)
+		{
+			break;
+		}
+		if (child + 1 < dstar->count
+			&& resuelve_dstar_before (&dstar->open[child + 1],
+										&dstar->open[child]))
+		{
+			child++;
+		}
+		if (!resuelve_dstar_before (&dstar->open[child], &entry))
+		{
+			break;
+		}
+		resuelve_dstar_place (dstar, i, dstar->open[child]);
+		i = child;
+	}
+	resuelve_dstar_place (dstar, i, entry);
+}
+
+/* take cell index off the open list
+ */
+static void resuelve_dstar_remove (struct ResuelveDstar *dstar, int index)
+{
+	int i = dstar->position[index];
+
+	dstar->position[index] = -1;
+	if (i < --dstar->count)
+	{
+		resuelve_dstar_place (dstar, i, dstar->open[dstar->count]);
+		resuelve_dstar_sift (dstar, i);
+	}
+}
+
+/* put cell index on the open list if it is unsettled, with fresh keys, and
+ * take it off if it is settled
+ */
+static void resuelve_dstar_update (struct ResuelveDstar *dstar, int index)
+{
+	int i = dstar->position[index];
+	struct ResuelveDstarEntry entry;
+
+	if (dstar->g[index] == dstar->rhs[index])
+	{
+		if (i >= 0)
+		{
+			resuelve_dstar_remove (dstar, index);
+		}
+		return;
+	}
+
+	resuelve_dstar_key (dstar, index, &entry);
+	if (i < 0)
+	{
+		// grow open list if full
+		if (dstar->count == dstar->capacity)
+		{
+			dstar->capacity *= 2;
+			dstar->open = realloc (dstar->open, 
+							dstar->capacity * sizeof (struct ResuelveDstarEntry));
+		}
+		i = dstar->count++;
+	}
+	resuelve_dstar_place (dstar, i, entry);
+	resuelve_dstar_sift (dstar, i);
+}
+
+/* return the distance to the finish of cell index seen from its neighbors
+ */
+static int resuelve_dstar_lookahead (struct ResuelveCourse *course,
+										struct ResuelveDstar *dstar, int index)
+{
+	int best = RESUELVE_DSTAR_FAR;
+	int d;
+
+	if (index == dstar->finish)
+	{
+		return 0;
+	}
+	RESUELVE_TOUCH_ROW (course, index / dstar->stride - 1);
+	if (course->map[index] == WALL)
+	{
+		return RESUELVE_DSTAR_FAR;
+	}
+
+	int neighbors = course->neighbors[index];
+	for (d = 0; d < 4; d++)
+	{
+		int next = index + dstar->offsets[d];
+		if ((neighbors & resuelve_dstar_open[d]) && dstar->g[next] + 1 < best)
+		{
+			best = dstar->g[next] + 1;
+		}
+	}
+
+	return best;
+}
+
+/* settle spaces in order of their keys until the start is settled and
+ * nothing left on the open list could change its distance
+ */
+static void resuelve_dstar_settle (struct ResuelveCourse *course,
+									struct ResuelveDstar *dstar)
+{
+	int *g = dstar->g;
+	int *rhs = dstar->rhs;
+	struct ResuelveDstarEntry goal;
+	struct ResuelveDstarEntry fresh;
+	int d;
+
+	while (dstar->count > 0)
+	{
+		struct ResuelveDstarEntry top = dstar->open[0];
+		int index = top.index;
+		resuelve_dstar_key (dstar, dstar->start, &goal);
+		if (!resuelve_dstar_before (&top, &goal) 
+			&& rhs[dstar->start] == g[dstar->start])
+		{
+			break;
+		}
+
+		// keys measured before the start moved may be too low
+		resuelve_dstar_key (dstar, index, &fresh);
+		if (resuelve_dstar_before (&top, &fresh))
+		{
+			resuelve_dstar_place (dstar, 0, fresh);
+			resuelve_dstar_sift (dstar, 0);
+			continue;
+		}
+
+		RESUELVE_TOUCH_ROW (course, index / dstar->stride - 1);
+		int neighbors = course->neighbors[index];
+		if (g[index] > rhs[index])
+		{
+			// distance went down, so settle it and pass it on
+			g[index] = rhs[index];
+			resuelve_dstar_remove (dstar, index);
+			for (d = 0; d < 4; d++)
+			{
+				int next = index + dstar->offsets[d];
+				if ((neighbors & resuelve_dstar_open[d]) 
+					&& g[index] + 1 < rhs[next])
+				{
+					rhs[next] = g[index] + 1;
+					resuelve_dstar_update (dstar, next);
+				}
+			}
+		}
+		else
+		{
+			// distance went up, so look again from this space and every
+			// neighbor that went through it
+			int old = g[index];
+			g[index] = RESUELVE_DSTAR_FAR;
+			for (d = 0; d < 4; d++)
+			{
+				int next = index + dstar->offsets[d];
+				if ((neighbors & resuelve_dstar_open[d]) 
+					&& rhs[next] == old + 1)
+				{
+					rhs[next] = resuelve_dstar_lookahead (course, dstar, next);
+					resuelve_dstar_update (dstar, next);
+				}
+			}
+			rhs[index] = resuelve_dstar_lookahead (course, dstar, index);
+			resuelve_dstar_update (dstar, index);
+		}
+	}
+}
+
+/* start a search back from the finish of the course
+ */
+static struct ResuelveDstar* resuelve_dstar_begin (
+											struct ResuelveCourse *course)
+{
+	struct ResuelveDstar *dstar = malloc (sizeof (struct ResuelveDstar));
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int i;
+
+	dstar->g = malloc (cells * sizeof (int));
+	dstar->rhs = malloc (cells * sizeof (int));
+	dstar->position = malloc (cells * sizeof (int));
+	for (i = 0; i < cells; i++)
+	{
+		dstar->g[i] = RESUELVE_DSTAR_FAR;
+		dstar->rhs[i] = RESUELVE_DSTAR_FAR;
+		dstar->position[i] = -1;
+	}
+	dstar->capacity = 64;
+	dstar->count = 0;
+	dstar->open = malloc (dstar->capacity * sizeof (struct ResuelveDstarEntry));
+	dstar->offsets[0] = -stride;
+	dstar->offsets[1] = 1;
+	dstar->offsets[2] = stride;
+	dstar->offsets[3] = -1;
+	dstar->stride = stride;
+	dstar->finish = RESUELVE_INDEX (course, course->finish_x, course->finish_y);
+	dstar->start = RESUELVE_INDEX (course, course->start_x, course->start_y);
+	dstar->moved = 0;
+
+	dstar->rhs[dstar->finish] = 0;
+	resuelve_dstar_update (dstar, dstar->finish);
+
+	return dstar;
+}
+
+/* find a shortest route from x, y to the finish of the course, repairing
+ * the search kept with the course, or starting one if there is none
+ * stores a malloc'd array of directions in route and returns its length,
+ * or RESUELVE_NO_PATH if the finish cannot be reached
+ */
+int resuelve_dstar_route (struct ResuelveCourse *course, int x, int y,
+							int **route)
+{
+	struct ResuelveDstar *dstar = course->dstar;
+	int index = RESUELVE_INDEX (course, x, y);
+	int i;
+
+	*route = NULL;
+
+	// spaces in different components have no way between them, though the
+	// labels are not worth finding again after every wall that changes
+	if (course->components != NULL
+		&& !resuelve_connected (course, x, y, course->finish_x, 
+								course->finish_y))
+	{
+		return RESUELVE_NO_PATH;
+	}
+
+	if (dstar == NULL)
+	{
+		dstar = resuelve_dstar_begin (course);
+		course->dstar = dstar;
+	}
+
+	// keys already on the open list stay low enough if the distance the
+	// start moved is added to every key measured from now on
+	dstar->moved += resuelve_dstar_heuristic (dstar, dstar->start, index);
+	dstar->start = index;
+	resuelve_dstar_settle (course, dstar);
+
+	int length = dstar->g[index];
+	if (length >= RESUELVE_DSTAR_FAR)
+	{
+		return RESUELVE_NO_PATH;
+	}
+
+	// every settled space on the way has a neighbor one closer
+	*route = malloc ((length + 1) * sizeof (int));
+	for (i = 0; i < length; i++)
+	{
+		int neighbors = course->neighbors[index];
+		int best = 0;
+		int d;
+		for (d = 1; d < 4; d++)
+		{
+			if ((neighbors & resuelve_dstar_open[d])
+				&& (!(neighbors & resuelve_dstar_open[best])
+					|| dstar->g[index + dstar->offsets[d]]
+						< dstar->g[index + dstar->offsets[best]]))
+			{
+				best = d;
+			}
+		}
+		(*route)[i] = resuelve_dstar_directions[best];
+		index += dstar->offsets[best];
+	}
+
+	return length;
+}
+
+/* repair the search kept with the course around cell x, y, after it is made
+ * a wall or opened up
+ */
+void resuelve_dstar_update_cell (struct ResuelveCourse *course, int x, int y)
+{
+	struct ResuelveDstar *dstar = course->dstar;
+	int index = RESUELVE_INDEX (course, x, y);
+	int d;
+
+	if (dstar == NULL)
+	{
+		return;
+	}
+
+	// only the cell and the spaces next to it can see a different distance
+	dstar->rhs[index] = resuelve_dstar_lookahead (course, dstar, index);
+	resuelve_dstar_update (dstar, index);
+	for (d = 0; d < 4; d++)
+	{
+		int next = index + dstar->offsets[d];
+		if (course->map[next] != WALL)
+		{
+			dstar->rhs[next] = resuelve_dstar_lookahead (course, dstar, next);
+			resuelve_dstar_update (dstar, next);
+		}
+	}
+}
+
+/* drop the search kept with the course, after the finish moves
+ */
+void resuelve_dstar_forget (struct ResuelveCourse *course)
+{
+	if (course->dstar == NULL)
+	{
+		return;
+	}
+
+	free (course->dstar->g);
+	free (course->dstar->rhs);
+	free (course->dstar->position);
+	free (course->dstar->open);
+	free (course->dstar);
+	course->dstar = NULL;
+}
+
+/* calculate a shortest path from start to finish with the search kept with
+ * the course and move the solver along it
+ * returns the number of moves made, or RESUELVE_NO_PATH
+ */
+int resuelve_calculate_path_dstar (struct ResuelveCourse *course,
+									struct ResuelveSolver *solver)
+{
+	return resuelve_solve_route (course, solver, resuelve_dstar_route);
+}
@@ -0,0 +1,39 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+/* D* Lite, a search that is kept with the course and repaired as the
+ * course changes instead of being run again
+ *
+ * the search runs back from the finish, so each space it settles keeps its
+ * distance to the finish. a wall added or removed with resuelve_set_wall
+ * only unsettles the spaces beside it, and the next route repairs the
+ * distances that passed through them and no others. the start may move
+ * between routes, either with resuelve_set_start or by asking for a route
+ * from where the robot now is. moving the finish throws the search away
+ *
+ * the first route costs more than an A* search, several times more on open
+ * floors. a repair costs as much as settling again the spaces whose way to
+ * the finish ran through the changed space: well under a millisecond where
+ * the route can step around it, but as much as a fresh search where the
+ * route must go down another corridor of a maze
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+struct ResuelveDstar;
+
+int resuelve_dstar_route (struct ResuelveCourse*, int, int, int**);
+void resuelve_dstar_update_cell (struct ResuelveCourse*, int, int);
+void resuelve_dstar_forget (struct ResuelveCourse*);
+int resuelve_calculate_path_dstar (struct ResuelveCourse*, struct ResuelveSolver*);
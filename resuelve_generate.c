@@ -0,0 +1,674 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* generate course files for testing and benchmarking
+ *
+ * usage: resuelve_generate [-t threads] [-p probability] family width height
+ *                          seed output
+ *   family       dfs         perfect maze carved depth first
+ *                braid       dfs maze with dead ends opened into loops, each
+ *                            with the given probability (default 0.5)
+ *                field       open field with walls placed at random with the
+ *                            given probability (default 0.3)
+ *                spiral      rings of walls, each with one gap on alternate
+ *                            sides, around a finish in the middle
+ *                adversarial lanes with pockets off the way through that
+ *                            the greedy solver walks into, each placed with
+ *                            the given probability (default 0.8)
+ *   -t threads   threads generating rows, default one per online processor
+ *   -p           probability used by the braid, field and adversarial
+ *                families
+ *
+ * width and height are in characters, including the outer walls
+ * the course is generated in bands of rows, each from its own seed, and each
+ * band is written as soon as it and the bands above it are done, so courses
+ * much larger than memory can be generated; the output depends only on the
+ * arguments, not on the number of threads
+ *
+ * build on its own, with -lpthread
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "unistd.h"
+
+#include "resuelve.h"
+#ifdef RESUELVE_THREADS
+#include "pthread.h"
+#endif
+
+// bytes of text each band of rows aims for
+#ifndef RESUELVE_GENERATE_BAND_BYTES
+#define RESUELVE_GENERATE_BAND_BYTES (8L << 20)
+#endif
+
+// distance between the walls of adversarial courses, and between the first
+// rows of the pockets in each lane, which is even so a solver walking down
+// a lane comes to every pocket the same way
+#define RESUELVE_GENERATE_LANE 8
+#define RESUELVE_GENERATE_POCKET 6
+
+enum
+{
+	RESUELVE_GENERATE_DFS,
+	RESUELVE_GENERATE_BRAID,
+	RESUELVE_GENERATE_FIELD,
+	RESUELVE_GENERATE_SPIRAL,
+	RESUELVE_GENERATE_ADVERSARIAL
+};
+
+static const char *resuelve_generate_families[] =
+{
+	"dfs", "braid", "field", "spiral", "adversarial", NULL
+};
+
+static const double resuelve_generate_probabilities[] =
+{
+	0, 0.5, 0.3, 0, 0.8
+};
+
+struct ResuelveGenerator
+{
+	int family;
+	int width;
+	int height;
+	unsigned long long seed;
+	double probability;
+	// maze cells across and down, each at odd coordinates
+	int cells_x;
+	int cells_y;
+	// maze cell rows in each band
+	int band_cells;
+	int bands;
+	// start and finish coordinates
+	int start_x;
+	int start_y;
+	int finish_x;
+	int finish_y;
+};
+
+struct ResuelveBand
+{
+	struct ResuelveGenerator *generator;
+	int index;
+	// text rows first through last - 1
+	int first;
+	int last;
+	// maze cell rows first_cell through last_cell - 1
+	int first_cell;
+	int last_cell;
+	char *text;
+	unsigned long long random;
+	// scratch space for depth first search
+	int *stack;
+};
+
+/* return the next number from a band's random sequence
+ */
+static unsigned long long resuelve_generate_next (struct ResuelveBand *band)
+{
+	// splitmix64
+	unsigned long long z = (band->random += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
+
+/* return a random number from 0 to limit - 1
+ */
+static int resuelve_generate_below (struct ResuelveBand *band, int limit)
+{
+	return (int) (resuelve_generate_next (band) % limit);
+}
+
+/* return 1 with the given probability
+ */
+static int resuelve_generate_chance (struct ResuelveBand *band,
+										double probability)
+{
+	return (resuelve_generate_next (band) >> 11) * (1.0 / 9007199254740992.0)
+			< probability;
+}
+
+/* return the character at x, y of a band
+ */
+static char *resuelve_generate_at (struct ResuelveBand *band, int x, int y)
+{
+	return band->text
+		+ (long) (y - band->first) * (band->generator->width + 1) + x;
+}
+
+/* carve a perfect maze through the cells of a band, depth first, joined to
+ * the band above by a single gap so the whole course stays a perfect maze
+ */
+static void resuelve_generate_dfs (struct ResuelveBand *band)
+{
+	struct ResuelveGenerator *generator = band->generator;
+	static const int dx[4] = { 0, 1, 0, -1 };
+	static const int dy[4] = { -1, 0, 1, 0 };
+	int rows = band->last_cell - band->first_cell;
+	int count = 0;
+
+	if (generator->cells_x == 0 || rows == 0)
+	{
+		return;
+	}
+
+	// cells are carved as they are visited, so open cells are visited cells
+	int cell = resuelve_generate_below (band, generator->cells_x * rows);
+	*resuelve_generate_at (band, 2 * (cell % generator->cells_x) + 1,
+				2 * (cell / generator->cells_x + band->first_cell) + 1) = '.';
+	band->stack[count++] = cell;
+
+	while (count > 0)
+	{
+		cell = band->stack[count - 1];
+		int cx = cell % generator->cells_x;
+		int cy = cell / generator->cells_x;
+		int choices[4];
+		int choice_count = 0;
+		int d;
+
+		for (d = 0; d < 4; d++)
+		{
+			int nx = cx + dx[d];
+			int ny = cy + dy[d];
+			if (nx >= 0 && nx < generator->cells_x && ny >= 0 && ny < rows
+				&& *resuelve_generate_at (band, 2 * nx + 1,
+								2 * (ny + band->first_cell) + 1) != '.')
+			{
+				choices[choice_count++] = d;
+			}
+		}
+
+		// dead end, so back up
+		if (choice_count == 0)
+		{
+			count--;
+			continue;
+		}
+
+		// knock down the wall to a random unvisited neighbor
+		d = choices[resuelve_generate_below (band, choice_count)];
+		int x = 2 * cx + 1;
+		int y = 2 * (cy + band->first_cell) + 1;
+		*resuelve_generate_at (band, x + dx[d], y + dy[d]) = '.';
+		*resuelve_generate_at (band, x + 2 * dx[d], y + 2 * dy[d]) = '.';
+		band->stack[count++] = (cy + dy[d]) * generator->cells_x + cx + dx[d];
+	}
+
+	// one gap in the wall row above joins the band to the one before it
+	if (band->first_cell > 0)
+	{
+		int gap = resuelve_generate_below (band, generator->cells_x);
+		*resuelve_generate_at (band, 2 * gap + 1, 2 * band->first_cell) = '.';
+	}
+}
+
+/* open dead ends of a band's perfect maze into loops
+ */
+static void resuelve_generate_braid (struct ResuelveBand *band)
+{
+	struct ResuelveGenerator *generator = band->generator;
+	static const int dx[4] = { 0, 1, 0, -1 };
+	static const int dy[4] = { -1, 0, 1, 0 };
+	int cx, cy, d;
+
+	resuelve_generate_dfs (band);
+
+	for (cy = band->first_cell; cy < band->last_cell; cy++)
+	{
+		for (cx = 0; cx < generator->cells_x; cx++)
+		{
+			int x = 2 * cx + 1;
+			int y = 2 * cy + 1;
+			int walls[4];
+			int wall_count = 0;
+			int open_count = 0;
+
+			// walls that lead to another cell of this band
+			for (d = 0; d < 4; d++)
+			{
+				int nx = cx + dx[d];
+				int ny = cy + dy[d];
+				// the wall row under the last cells belongs to the next band
+				if (y + dy[d] >= band->last)
+				{
+					continue;
+				}
+				if (*resuelve_generate_at (band, x + dx[d], y + dy[d]) == '.')
+				{
+					open_count++;
+				}
+				else if (nx >= 0 && nx < generator->cells_x
+						&& ny >= band->first_cell && ny < band->last_cell)
+				{
+					walls[wall_count++] = d;
+				}
+			}
+
+			if (open_count == 1 && wall_count > 0
+				&& resuelve_generate_chance (band, generator->probability))
+			{
+				d = walls[resuelve_generate_below (band, wall_count)];
+				*resuelve_generate_at (band, x + dx[d], y + dy[d]) = '.';
+			}
+		}
+	}
+}
+
+/* fill a band with open space and walls placed at random
+ */
+static void resuelve_generate_field (struct ResuelveBand *band)
+{
+	struct ResuelveGenerator *generator = band->generator;
+	int x, y;
+
+	for (y = band->first; y < band->last; y++)
+	{
+		if (y == 0 || y == generator->height - 1)
+		{
+			continue;
+		}
+		char *row = resuelve_generate_at (band, 0, y);
+		for (x = 1; x < generator->width - 1; x++)
+		{
+			if (!resuelve_generate_chance (band, generator->probability))
+			{
+				row[x] = '.';
+			}
+		}
+	}
+}
+
+/* fill a band with its rows of the spiral rings
+ */
+static void resuelve_generate_spiral (struct ResuelveBand *band)
+{
+	struct ResuelveGenerator *generator = band->generator;
+	int width = generator->width;
+	int height = generator->height;
+	int x, y;
+
+	for (y = band->first; y < band->last; y++)
+	{
+		char *row = resuelve_generate_at (band, 0, y);
+		for (x = 0; x < width; x++)
+		{
+			// distance from the outer wall picks the ring
+			int ring = x;
+			ring = y < ring ? y : ring;
+			ring = width - 1 - x < ring ? width - 1 - x : ring;
+			ring = height - 1 - y < ring ? height - 1 - y : ring;
+
+			// odd rings are corridors, even ones walls with a single gap,
+			// alternating between the top left and bottom right
+			if (ring % 2 == 1 || (ring > 0 && ((ring / 2) % 2 == 1
+					? x == ring && y == ring + 1
+					: x == width - 1 - ring && y == height - 2 - ring)))
+			{
+				row[x] = '.';
+			}
+		}
+	}
+}
+
+/* return 1 if pocket number pocket of lane number lane of the adversarial
+ * course is made, with the course's probability
+ * pockets can cross from one band into the next, so this depends only on
+ * the seed and the pocket, not on a band's random sequence
+ */
+static int resuelve_generate_pocket (struct ResuelveGenerator *generator,
+										int lane, int pocket)
+{
+	struct ResuelveBand place;
+
+	place.random = generator->seed ^ (0x9E3779B97F4A7C15ULL 
+						* (((unsigned long long) lane << 32) + pocket));
+	return resuelve_generate_chance (&place, generator->probability);
+}
+
+/* fill a band with its rows of the adversarial course
+ * full height walls leave a gap at the top and bottom in turn, and the way
+ * on runs up or down the left side of each lane between them; pockets open
+ * off it to the right, two rows across the lane joined at the far end, so
+ * a solver heading right for the finish walks in along one row and back
+ * out along the other, without ever being boxed in by its own path
+ */
+static void resuelve_generate_adversarial (struct ResuelveBand *band)
+{
+	struct ResuelveGenerator *generator = band->generator;
+	int width = generator->width;
+	int height = generator->height;
+	int lane = RESUELVE_GENERATE_LANE;
+	int pocket = RESUELVE_GENERATE_POCKET;
+	int x, y;
+
+	for (y = band->first; y < band->last; y++)
+	{
+		if (y == 0 || y == height - 1)
+		{
+			continue;
+		}
+		char *row = resuelve_generate_at (band, 0, y);
+		for (x = 1; x < width - 1; x++)
+		{
+			// lanes with an odd index are walked down, the rest up
+			int index = x / lane;
+			int down = index % 2 == 1;
+
+			// a wall leaves a gap onto the first row walked in the lane to
+			// its right, and a wall in the finish's column only leads to it
+			if (x % lane == 0)
+			{
+				int gap = x == width - 2 || !down ? y == height - 2 : y == 1;
+				row[x] = gap ? '.' : 'x';
+				continue;
+			}
+			int first = index * lane + 1;
+			int last = first + lane - 2 < width - 2 
+						? first + lane - 2 : width - 2;
+			int finish = last >= width - 3;
+
+			// the start's lane is only the top row, leading to the first
+			// gap, unless the finish is in it too
+			if (index == 0 && !finish)
+			{
+				row[x] = y == 1 ? '.' : 'x';
+				continue;
+			}
+
+			// lanes are crossed along the row of the gap they are left by,
+			// but the finish's lane only along the bottom row to the finish
+			int open = x == first 
+						|| y == (down || finish ? height - 2 : 1);
+
+			// pockets are three rows, open on the first and last, and are
+			// kept a row away from the top and bottom rows
+			int part = (y - 3) % pocket;
+			if (!open && y >= 3 && part < 3 && y + 2 - part < height - 3
+				&& last - first >= 2 
+				&& resuelve_generate_pocket (generator, index, (y - 3) / pocket))
+			{
+				open = part != 1 || x == last;
+			}
+			row[x] = open ? '.' : 'x';
+		}
+	}
+}
+
+/* generate the rows of one band
+ */
+static void *resuelve_generate_band (void *data)
+{
+	struct ResuelveBand *band = data;
+	struct ResuelveGenerator *generator = band->generator;
+	int width = generator->width;
+	int y;
+
+	// each band has its own seed, so bands can be made in any order
+	band->random = generator->seed ^ (0xD1B54A32D192ED03ULL * (band->index + 1));
+
+	// start with walls and carve the family out of them
+	for (y = band->first; y < band->last; y++)
+	{
+		char *row = resuelve_generate_at (band, 0, y);
+		memset (row, WALL_MARKER[0], width);
+		row[width] = '\n';
+	}
+
+	switch (generator->family)
+	{
+		case RESUELVE_GENERATE_DFS:
+			resuelve_generate_dfs (band);
+			break;
+		case RESUELVE_GENERATE_BRAID:
+			resuelve_generate_braid (band);
+			break;
+		case RESUELVE_GENERATE_FIELD:
+			resuelve_generate_field (band);
+			break;
+		case RESUELVE_GENERATE_SPIRAL:
+			resuelve_generate_spiral (band);
+			break;
+		case RESUELVE_GENERATE_ADVERSARIAL:
+			resuelve_generate_adversarial (band);
+			break;
+	}
+
+	// markers go in whichever band holds them
+	if (generator->start_y >= band->first && generator->start_y < band->last)
+	{
+		*resuelve_generate_at (band, generator->start_x, generator->start_y) =
+			START_MARKER[0];
+	}
+	if (generator->finish_y >= band->first && generator->finish_y < band->last)
+	{
+		*resuelve_generate_at (band, generator->finish_x,
+								generator->finish_y) = FINISH_MARKER[0];
+	}
+
+	return NULL;
+}
+
+/* set up the rows and markers of band index of the course
+ */
+static void resuelve_generate_place_band (struct ResuelveGenerator *generator,
+											struct ResuelveBand *band,
+											int index)
+{
+	band->index = index;
+	band->first_cell = index * generator->band_cells;
+	band->last_cell = band->first_cell + generator->band_cells;
+	if (band->last_cell > generator->cells_y)
+	{
+		band->last_cell = generator->cells_y;
+	}
+
+	// each band holds the wall row above each of its cells, and the last
+	// band everything below them
+	band->first = 2 * band->first_cell;
+	band->last = index == generator->bands - 1
+					? generator->height : 2 * band->last_cell;
+}
+
+int main (int argc, char **argv)
+{
+	struct ResuelveGenerator generator;
+	int threads = 0;
+	double probability = -1;
+	int arg = 1;
+	int i;
+
+	while (argc > arg + 1 && argv[arg][0] == '-')
+	{
+		if (strcmp (argv[arg], "-t") == 0)
+		{
+			threads = atoi (argv[arg + 1]);
+		}
+		else if (strcmp (argv[arg], "-p") == 0)
+		{
+			probability = atof (argv[arg + 1]);
+		}
+		else
+		{
+			break;
+		}
+		arg += 2;
+	}
+	if (argc - arg != 5)
+	{
+		printf ("usage: %s [-t threads] [-p probability] "
+				"dfs|braid|field|spiral|adversarial width height seed "
+				"output\n", argv[0]);
+		return 1;
+	}
+
+	generator.family = -1;
+	for (i = 0; resuelve_generate_families[i] != NULL; i++)
+	{
+		if (strcmp (argv[arg], resuelve_generate_families[i]) == 0)
+		{
+			generator.family = i;
+		}
+	}
+	generator.width = atoi (argv[arg + 1]);
+	generator.height = atoi (argv[arg + 2]);
+	generator.seed = strtoull (argv[arg + 3], NULL, 10);
+	if (generator.family < 0 || generator.width < 3 || generator.height < 3)
+	{
+		printf ("Unknown family or course smaller than 3 x 3\n");
+		return 1;
+	}
+	generator.probability = probability >= 0
+		? probability : resuelve_generate_probabilities[generator.family];
+
+	// maze cells sit at odd coordinates, with walls between them
+	generator.cells_x = (generator.width - 1) / 2;
+	generator.cells_y = (generator.height - 1) / 2;
+	generator.band_cells =
+		RESUELVE_GENERATE_BAND_BYTES / (2L * (generator.width + 1));
+	if (generator.band_cells < 1)
+	{
+		generator.band_cells = 1;
+	}
+	generator.bands =
+		(generator.cells_y + generator.band_cells - 1) / generator.band_cells;
+	if (generator.bands < 1)
+	{
+		generator.bands = 1;
+	}
+
+	// start in the top left, finish in the bottom right, or in the middle of
+	// a spiral
+	generator.start_x = 1;
+	generator.start_y = 1;
+	generator.finish_x = 2 * generator.cells_x - 1;
+	generator.finish_y = 2 * generator.cells_y - 1;
+	if (generator.family == RESUELVE_GENERATE_SPIRAL)
+	{
+		int middle = (generator.width < generator.height
+						? generator.width : generator.height) - 1;
+		middle = middle / 2 % 2 == 1 ? middle / 2 : middle / 2 - 1;
+		generator.finish_x = middle;
+		generator.finish_y = middle;
+	}
+	else if (generator.family != RESUELVE_GENERATE_DFS
+				&& generator.family != RESUELVE_GENERATE_BRAID)
+	{
+		generator.finish_x = generator.width - 2;
+		generator.finish_y = generator.height - 2;
+	}
+
+	if (generator.start_x == generator.finish_x
+		&& generator.start_y == generator.finish_y)
+	{
+		printf ("Course too small for %s\n", argv[arg]);
+		return 1;
+	}
+
+	FILE *output = fopen (argv[arg + 4], "wb");
+	if (output == NULL)
+	{
+		printf ("Could not open %s\n", argv[arg + 4]);
+		return 1;
+	}
+
+#ifdef RESUELVE_THREADS
+	if (threads <= 0)
+	{
+		threads = sysconf (_SC_NPROCESSORS_ONLN);
+	}
+#endif
+	if (threads <= 0)
+	{
+		threads = 1;
+	}
+	if (threads > generator.bands)
+	{
+		threads = generator.bands;
+	}
+
+	// one buffer per thread, each big enough for the largest band
+	struct ResuelveBand *bands = malloc (threads * sizeof (struct ResuelveBand));
+	long band_rows = 2L * generator.band_cells + 2;
+	for (i = 0; i < threads; i++)
+	{
+		bands[i].generator = &generator;
+		bands[i].text = malloc (band_rows * (generator.width + 1));
+		bands[i].stack = malloc ((long) generator.band_cells
+									* (generator.cells_x + 1) * sizeof (int));
+	}
+
+	// make bands a round of threads at a time, writing them out in order
+	int round;
+	for (round = 0; round < generator.bands; round += threads)
+	{
+		int count = generator.bands - round < threads
+					? generator.bands - round : threads;
+
+#ifdef RESUELVE_THREADS
+		pthread_t ids[count];
+		for (i = 0; i < count; i++)
+		{
+			resuelve_generate_place_band (&generator, &bands[i], round + i);
+			if (pthread_create (&ids[i], NULL, resuelve_generate_band,
+								&bands[i]) != 0)
+			{
+				ids[i] = pthread_self ();
+				resuelve_generate_band (&bands[i]);
+			}
+		}
+		for (i = 0; i < count; i++)
+		{
+			if (!pthread_equal (ids[i], pthread_self ()))
+			{
+				pthread_join (ids[i], NULL);
+			}
+		}
+#else
+		for (i = 0; i < count; i++)
+		{
+			resuelve_generate_place_band (&generator, &bands[i], round + i);
+			resuelve_generate_band (&bands[i]);
+		}
+#endif
+
+		for (i = 0; i < count; i++)
+		{
+			long length = (long) (bands[i].last - bands[i].first)
+							* (generator.width + 1);
+			if (fwrite (bands[i].text, 1, length, output) != (size_t) length)
+			{
+				printf ("Could not write %s\n", argv[arg + 4]);
+				fclose (output);
+				return 1;
+			}
+		}
+	}
+
+	for (i = 0; i < threads; i++)
+	{
+		free (bands[i].text);
+		free (bands[i].stack);
+	}
+	free (bands);
+
+	if (fclose (output) != 0)
+	{
+		printf ("Could not write %s\n", argv[arg + 4]);
+		return 1;
+	}
+	printf ("Wrote %s (%d x %d)\n", argv[arg + 4], generator.width,
+			generator.height);
+
+	return 0;
+}
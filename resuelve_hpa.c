@@ -0,0 +1,809 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_hpa.h"
+#include "resuelve_astar.h"
+#include "resuelve_parse.h"
+#include "resuelve_components.h"
+
+// side of the square clusters the course is cut into, at most 64 so each
+// row of a cluster fits in a word of bits
+#ifndef RESUELVE_HPA_CLUSTER
+#define RESUELVE_HPA_CLUSTER 32
+#endif
+
+// rows of clusters each building thread is given at least, and the most
+// threads used, where 0 means one per online processor
+#ifndef RESUELVE_HPA_ROWS
+#define RESUELVE_HPA_ROWS 8
+#endif
+#ifndef RESUELVE_HPA_THREADS
+#define RESUELVE_HPA_THREADS 0
+#endif
+
+// open runs along the edge of a cluster at least this long get an entrance
+// at each end instead of one in the middle
+#define RESUELVE_HPA_WIDE 6
+
+// most entrances a cluster can have, with room for the start and finish of
+// a search; an entrance numbered k of cluster c is known to the search as
+// c * RESUELVE_HPA_SLOTS + k
+#define RESUELVE_HPA_SLOTS (4 * RESUELVE_HPA_CLUSTER + 2)
+
+// directions in the order neighbors are tried
+static const int resuelve_hpa_directions[4] = { UP, RIGHT, DOWN, LEFT };
+static const int resuelve_hpa_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+struct ResuelveHpaNode
+{
+	int index;
+	// cost from the start plus one and the entrance it was reached from,
+	// which only hold for the search numbered seen, and the search that
+	// last expanded it
+	int g;
+	int parent;
+	int seen;
+	int closed;
+};
+
+struct ResuelveHpaCluster
+{
+	int x;
+	int y;
+	int width;
+	int height;
+	struct ResuelveHpaNode* nodes;
+	int count;
+	// distance between each pair of entrances without leaving the cluster,
+	// or -1 if there is no way, in rows of room
+	int* distances;
+	int room;
+};
+
+struct ResuelveHpa
+{
+	int columns;
+	int rows;
+	struct ResuelveHpaCluster* clusters;
+	// distances out from one space of a cluster, in rows of a cluster plus
+	// a border either side that is never entered, and the cells and places
+	// in measured waiting to be looked at
+	int* measured;
+	int* queue;
+	int* places;
+	int search;
+};
+
+// row of hpa->measured
+#define RESUELVE_HPA_ROW (RESUELVE_HPA_CLUSTER + 2)
+
+/* return the number of the cluster holding cell index
+ */
+static int resuelve_hpa_cluster (struct ResuelveCourse *course,
+									struct ResuelveHpa *hpa, int index)
+{
+	int x = index % course->stride - 1;
+	int y = index / course->stride - 1;
+
+	return (y / RESUELVE_HPA_CLUSTER) * hpa->columns + x / RESUELVE_HPA_CLUSTER;
+}
+
+/* return the place of cell index of cluster in hpa->measured
+ */
+static int resuelve_hpa_local (struct ResuelveCourse *course,
+								struct ResuelveHpaCluster *cluster, int index)
+{
+	int x = index % course->stride - 1 - cluster->x;
+	int y = index / course->stride - 1 - cluster->y;
+
+	return (y + 1) * RESUELVE_HPA_ROW + x + 1;
+}
+
+/* find the distance from cell index to every space of cluster that can be
+ * reached without leaving it, into hpa->measured, -1 for the rest
+ */
+static void resuelve_hpa_measure (struct ResuelveCourse *course,
+									struct ResuelveHpa *hpa,
+									struct ResuelveHpaCluster *cluster,
+									int index)
+{
+	int stride = course->stride;
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int steps[4] = { -RESUELVE_HPA_ROW, 1, RESUELVE_HPA_ROW, -1 };
+	int *measured = hpa->measured;
+	int *queue = hpa->queue;
+	int *places = hpa->places;
+	unsigned char *all_neighbors = course->neighbors;
+	int head = 0;
+	int tail = 0;
+	int x;
+	int y;
+
+	// spaces outside the cluster are marked so they are never entered
+	for (y = 0; y < cluster->height + 2; y++)
+	{
+		int *row = measured + y * RESUELVE_HPA_ROW;
+		int inside = y > 0 && y <= cluster->height;
+		for (x = 0; x < cluster->width + 2; x++)
+		{
+			row[x] = inside && x > 0 && x <= cluster->width ? -1 : -2;
+		}
+	}
+	places[tail] = resuelve_hpa_local (course, cluster, index);
+	queue[tail++] = index;
+	measured[places[0]] = 0;
+
+	while (head < tail)
+	{
+		int cell = queue[head];
+		int here = places[head++];
+		int neighbors = all_neighbors[cell];
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			int there = here + steps[d];
+			if ((neighbors & resuelve_hpa_open[d]) && measured[there] == -1)
+			{
+				measured[there] = measured[here] + 1;
+				places[tail] = there;
+				queue[tail++] = cell + offsets[d];
+			}
+		}
+	}
+}
+
+/* add cell index to found unless it is already there, as corners may be
+ * on two edges
+ * returns the number of cells found
+ */
+static int resuelve_hpa_add (int *found, int count, int index)
+{
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		if (found[i] == index)
+		{
+			return count;
+		}
+	}
+	found[count] = index;
+
+	return count + 1;
+}
+
+/* add the entrances along one edge of a cluster to found, walking length
+ * cells from cell first by step, where across is the offset to the cell on
+ * the other side of the edge
+ * the course is bordered by walls, so edges along it have no entrances
+ * returns the number of cells found
+ */
+static int resuelve_hpa_edge (struct ResuelveCourse *course, int *found,
+								int count, int first, int step, int across,
+								int length)
+{
+	int run = 0;
+	int i;
+
+	for (i = 0; i <= length; i++)
+	{
+		int cell = first + i * step;
+		if (i < length && course->map[cell] != WALL 
+			&& course->map[cell + across] != WALL)
+		{
+			run++;
+			continue;
+		}
+		if (run == 0)
+		{
+			continue;
+		}
+
+		// run of open spaces on both sides ended at the cell before
+		int start = cell - run * step;
+		if (run < RESUELVE_HPA_WIDE)
+		{
+			count = resuelve_hpa_add (found, count, start + run / 2 * step);
+		}
+		else
+		{
+			count = resuelve_hpa_add (found, count, start);
+			count = resuelve_hpa_add (found, count, cell - step);
+		}
+		run = 0;
+	}
+
+	return count;
+}
+
+/* find the distances from entrance first of cluster to the entrances after
+ * it, growing the spaces reached by a row of bits at a time, where open
+ * holds the spaces of each row of the cluster and x and y the place of
+ * each entrance in it
+ */
+static void resuelve_hpa_spread (struct ResuelveHpaCluster *cluster,
+									uint64_t *open, int *x, int *y, int first)
+{
+	uint64_t reached[RESUELVE_HPA_CLUSTER];
+	uint64_t frontier[RESUELVE_HPA_CLUSTER + 2];
+	uint64_t next[RESUELVE_HPA_CLUSTER];
+	int room = cluster->room;
+	int wanted = cluster->count - 1 - first;
+	int distance = 0;
+	int j;
+
+	for (j = first + 1; j < cluster->count; j++)
+	{
+		cluster->distances[first * room + j] = -1;
+		cluster->distances[j * room + first] = -1;
+	}
+
+	// frontier keeps an empty row either side, and only rows from low to
+	// high can hold any of it
+	memset (reached, 0, sizeof (reached));
+	memset (frontier, 0, sizeof (frontier));
+	reached[y[first]] = (uint64_t) 1 << x[first];
+	frontier[y[first] + 1] = reached[y[first]];
+	int low = y[first];
+	int high = y[first];
+
+	while (wanted > 0 && low <= high)
+	{
+		int row;
+		distance++;
+		if (low > 0)
+		{
+			low--;
+		}
+		if (high < cluster->height - 1)
+		{
+			high++;
+		}
+		for (row = low; row <= high; row++)
+		{
+			uint64_t here = frontier[row + 1];
+			next[row] = (here << 1 | here >> 1 | frontier[row] 
+							| frontier[row + 2]) & open[row] & ~reached[row];
+		}
+
+		// narrow the rows to those still growing
+		int grew = 0;
+		int top = high;
+		int bottom = low;
+		for (row = low; row <= high; row++)
+		{
+			frontier[row + 1] = next[row];
+			reached[row] |= next[row];
+			if (next[row] != 0)
+			{
+				top = row < top ? row : top;
+				bottom = row;
+				grew = 1;
+			}
+		}
+		if (!grew)
+		{
+			break;
+		}
+		low = top;
+		high = bottom;
+
+		for (j = first + 1; j < cluster->count; j++)
+		{
+			if ((frontier[y[j] + 1] >> x[j]) & 1)
+			{
+				cluster->distances[first * room + j] = distance;
+				cluster->distances[j * room + first] = distance;
+				wanted--;
+			}
+		}
+	}
+}
+
+/* find the entrances of cluster and the distances between them
+ */
+static void resuelve_hpa_build_cluster (struct ResuelveCourse *course,
+										struct ResuelveHpaCluster *cluster)
+{
+	int found[RESUELVE_HPA_SLOTS];
+	int x[RESUELVE_HPA_SLOTS];
+	int y[RESUELVE_HPA_SLOTS];
+	uint64_t open[RESUELVE_HPA_CLUSTER];
+	int stride = course->stride;
+	int top = RESUELVE_INDEX (course, cluster->x, cluster->y);
+	int bottom = top + (cluster->height - 1) * stride;
+	int right = top + cluster->width - 1;
+	int count = 0;
+	int i;
+	int j;
+
+	count = resuelve_hpa_edge (course, found, count, top, 1, -stride, 
+								cluster->width);
+	count = resuelve_hpa_edge (course, found, count, bottom, 1, stride,
+								cluster->width);
+	count = resuelve_hpa_edge (course, found, count, top, stride, -1,
+								cluster->height);
+	count = resuelve_hpa_edge (course, found, count, right, stride, 1,
+								cluster->height);
+
+	free (cluster->nodes);
+	free (cluster->distances);
+	cluster->count = count;
+	cluster->room = count + 2;
+	cluster->nodes = calloc (cluster->room, sizeof (struct ResuelveHpaNode));
+	cluster->distances = malloc (cluster->room * cluster->room * sizeof (int));
+	for (i = 0; i < count; i++)
+	{
+		cluster->nodes[i].index = found[i];
+		x[i] = found[i] % stride - 1 - cluster->x;
+		y[i] = found[i] / stride - 1 - cluster->y;
+		cluster->distances[i * cluster->room + i] = 0;
+	}
+
+	// spaces of each row as bits
+	for (i = 0; i < cluster->height; i++)
+	{
+		RESUELVE_MAP row = course->map + top + i * stride;
+		open[i] = 0;
+		for (j = 0; j < cluster->width; j++)
+		{
+			if (row[j] != WALL)
+			{
+				open[i] |= (uint64_t) 1 << j;
+			}
+		}
+	}
+
+	for (i = 0; i + 1 < count; i++)
+	{
+		resuelve_hpa_spread (cluster, open, x, y, i);
+	}
+}
+
+/* find the entrances of each cluster in rows first up to last
+ */
+static void resuelve_hpa_build_rows (struct ResuelveCourse *course,
+										struct ResuelveHpa *hpa, int first,
+										int last)
+{
+	int size = RESUELVE_HPA_CLUSTER;
+	int x;
+	int y;
+
+	for (y = first; y < last; y++)
+	{
+		for (x = 0; x < hpa->columns; x++)
+		{
+			struct ResuelveHpaCluster *cluster = 
+				&hpa->clusters[y * hpa->columns + x];
+			cluster->x = x * size;
+			cluster->y = y * size;
+			cluster->width = course->size_x - cluster->x < size
+								? course->size_x - cluster->x : size;
+			cluster->height = course->size_y - cluster->y < size
+								? course->size_y - cluster->y : size;
+			resuelve_hpa_build_cluster (course, cluster);
+		}
+	}
+}
+
+#ifdef RESUELVE_THREADS
+// range of cluster rows built by one thread
+struct ResuelveHpaJob
+{
+	struct ResuelveCourse *course;
+	struct ResuelveHpa *hpa;
+	int first;
+	int last;
+};
+
+/* thread body building one range of cluster rows
+ */
+static void *resuelve_hpa_job (void *data)
+{
+	struct ResuelveHpaJob *job = data;
+
+	resuelve_hpa_build_rows (job->course, job->hpa, job->first, job->last);
+
+	return NULL;
+}
+#endif
+
+/* cut the course into clusters and find the entrances of each, keeping
+ * them with the course
+ */
+void resuelve_hpa_build (struct ResuelveCourse *course)
+{
+	struct ResuelveHpa *hpa;
+	int size = RESUELVE_HPA_CLUSTER;
+
+	resuelve_load_all_rows (course);
+	resuelve_hpa_forget (course);
+
+	hpa = malloc (sizeof (struct ResuelveHpa));
+	hpa->columns = (course->size_x + size - 1) / size;
+	hpa->rows = (course->size_y + size - 1) / size;
+	hpa->clusters = calloc (hpa->columns * hpa->rows, 
+							sizeof (struct ResuelveHpaCluster));
+	hpa->measured = malloc (RESUELVE_HPA_ROW * RESUELVE_HPA_ROW * sizeof (int));
+	hpa->queue = malloc (size * size * sizeof (int));
+	hpa->places = malloc (size * size * sizeof (int));
+	hpa->search = 0;
+
+	// clusters only write their own entrances, so ranges of cluster rows
+	// can be built on their own threads without locking
+#ifdef RESUELVE_THREADS
+	int threads = resuelve_thread_count (RESUELVE_HPA_THREADS, 
+											hpa->rows / RESUELVE_HPA_ROWS);
+	if (threads > 1)
+	{
+		struct ResuelveHpaJob *jobs = 
+			malloc (threads * sizeof (struct ResuelveHpaJob));
+		int i;
+
+		for (i = 0; i < threads; i++)
+		{
+			jobs[i].course = course;
+			jobs[i].hpa = hpa;
+			jobs[i].first = (long) hpa->rows * i / threads;
+			jobs[i].last = (long) hpa->rows * (i + 1) / threads;
+		}
+		resuelve_run_threads (resuelve_hpa_job, jobs, threads, 
+								sizeof (struct ResuelveHpaJob));
+
+		free (jobs);
+		course->hpa = hpa;
+		return;
+	}
+#endif
+
+	resuelve_hpa_build_rows (course, hpa, 0, hpa->rows);
+	course->hpa = hpa;
+}
+
+/* find the entrances of the clusters around cell x, y again, after it is
+ * made a wall or opened up
+ */
+void resuelve_hpa_update_cell (struct ResuelveCourse *course, int x, int y)
+{
+	struct ResuelveHpa *hpa = course->hpa;
+	int size = RESUELVE_HPA_CLUSTER;
+
+	if (hpa == NULL)
+	{
+		return;
+	}
+
+	// a cell on the edge of its cluster also decides entrances of the
+	// cluster across that edge
+	int column = x / size;
+	int row = y / size;
+	int i = row * hpa->columns + column;
+	resuelve_hpa_build_cluster (course, &hpa->clusters[i]);
+	if (x % size == 0 && column > 0)
+	{
+		resuelve_hpa_build_cluster (course, &hpa->clusters[i - 1]);
+	}
+	if (x % size == size - 1 && column + 1 < hpa->columns)
+	{
+		resuelve_hpa_build_cluster (course, &hpa->clusters[i + 1]);
+	}
+	if (y % size == 0 && row > 0)
+	{
+		resuelve_hpa_build_cluster (course, 
+									&hpa->clusters[i - hpa->columns]);
+	}
+	if (y % size == size - 1 && row + 1 < hpa->rows)
+	{
+		resuelve_hpa_build_cluster (course, 
+									&hpa->clusters[i + hpa->columns]);
+	}
+}
+
+/* drop the clusters, to be built again when next needed
+ */
+void resuelve_hpa_forget (struct ResuelveCourse *course)
+{
+	struct ResuelveHpa *hpa = course->hpa;
+	int i;
+
+	if (hpa == NULL)
+	{
+		return;
+	}
+
+	for (i = 0; i < hpa->columns * hpa->rows; i++)
+	{
+		free (hpa->clusters[i].nodes);
+		free (hpa->clusters[i].distances);
+	}
+	free (hpa->clusters);
+	free (hpa->measured);
+	free (hpa->queue);
+	free (hpa->places);
+	free (hpa);
+	course->hpa = NULL;
+}
+
+/* add cell index to cluster as an entrance for the current search only,
+ * with its distances to the entrances already there
+ * returns its number among the entrances of the cluster
+ */
+static int resuelve_hpa_insert (struct ResuelveCourse *course,
+								struct ResuelveHpa *hpa,
+								struct ResuelveHpaCluster *cluster, int index)
+{
+	int k = cluster->count++;
+	int j;
+
+	cluster->nodes[k].index = index;
+	cluster->nodes[k].seen = 0;
+	cluster->nodes[k].closed = 0;
+	resuelve_hpa_measure (course, hpa, cluster, index);
+	for (j = 0; j <= k; j++)
+	{
+		int distance = 
+			hpa->measured[resuelve_hpa_local (course, cluster, 
+												cluster->nodes[j].index)];
+		cluster->distances[k * cluster->room + j] = distance;
+		cluster->distances[j * cluster->room + k] = distance;
+	}
+
+	return k;
+}
+
+/* put entrance k of cluster c on the open list with cost, reached from
+ * entrance parent, unless it already has a way as cheap
+ */
+static void resuelve_hpa_relax (struct ResuelveCourse *course,
+								struct ResuelveHpa *hpa,
+								struct ResuelveAstarHeap *open, int c, int k,
+								int cost, int parent)
+{
+	struct ResuelveHpaNode *node = &hpa->clusters[c].nodes[k];
+	int stride = course->stride;
+
+	if (node->closed == hpa->search 
+		|| (node->seen == hpa->search && node->g <= cost))
+	{
+		return;
+	}
+
+	node->seen = hpa->search;
+	node->g = cost;
+	node->parent = parent;
+	int h = abs (node->index % stride - 1 - course->finish_x)
+			+ abs (node->index / stride - 1 - course->finish_y);
+	resuelve_astar_push (open, cost - 1 + h, h, c * RESUELVE_HPA_SLOTS + k);
+}
+
+/* fill route with the moves from cell from to cell to, which are either
+ * next to each other across the edge of two clusters or in cluster
+ * returns the number of moves filled
+ */
+static int resuelve_hpa_refine (struct ResuelveCourse *course,
+								struct ResuelveHpa *hpa,
+								struct ResuelveHpaCluster *cluster, int from,
+								int to, int *route)
+{
+	int stride = course->stride;
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int length;
+	int i;
+	int d;
+
+	// one step over the edge
+	for (d = 0; d < 4; d++)
+	{
+		if (from + offsets[d] == to)
+		{
+			route[0] = resuelve_hpa_directions[d];
+			return 1;
+		}
+	}
+
+	// follow the distances to to back down through the cluster
+	resuelve_hpa_measure (course, hpa, cluster, to);
+	length = hpa->measured[resuelve_hpa_local (course, cluster, from)];
+	int here = resuelve_hpa_local (course, cluster, from);
+	int steps[4] = { -RESUELVE_HPA_ROW, 1, RESUELVE_HPA_ROW, -1 };
+	for (i = 0; i < length; i++)
+	{
+		int neighbors = course->neighbors[from];
+		for (d = 0; d < 4; d++)
+		{
+			if ((neighbors & resuelve_hpa_open[d])
+				&& hpa->measured[here + steps[d]] == length - i - 1)
+			{
+				break;
+			}
+		}
+		route[i] = resuelve_hpa_directions[d];
+		from += offsets[d];
+		here += steps[d];
+	}
+
+	return length;
+}
+
+/* find a route from x, y to the finish of the course over the entrances of
+ * its clusters, building them first if the course has none
+ * stores a malloc'd array of directions in route and returns its length,
+ * or RESUELVE_NO_PATH if the finish cannot be reached
+ */
+int resuelve_hpa_route (struct ResuelveCourse *course, int x, int y,
+						int **route)
+{
+	int stride = course->stride;
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int start = RESUELVE_INDEX (course, x, y);
+	int finish = RESUELVE_INDEX (course, course->finish_x, course->finish_y);
+	int length = RESUELVE_NO_PATH;
+	int d;
+
+	*route = NULL;
+
+	// spaces in different components have no way between them, though the
+	// labels are not worth finding again after every wall that changes
+	if (course->components != NULL
+		&& !resuelve_connected (course, x, y, course->finish_x, 
+								course->finish_y))
+	{
+		return RESUELVE_NO_PATH;
+	}
+	if (start == finish)
+	{
+		*route = malloc (sizeof (int));
+		return 0;
+	}
+
+	if (course->hpa == NULL)
+	{
+		resuelve_hpa_build (course);
+	}
+	struct ResuelveHpa *hpa = course->hpa;
+	hpa->search++;
+
+	// start and finish join the entrances of their clusters
+	int first = resuelve_hpa_cluster (course, hpa, start);
+	int last = resuelve_hpa_cluster (course, hpa, finish);
+	int from = resuelve_hpa_insert (course, hpa, &hpa->clusters[first], 
+									start);
+	int to = resuelve_hpa_insert (course, hpa, &hpa->clusters[last], finish);
+	int goal = last * RESUELVE_HPA_SLOTS + to;
+
+	struct ResuelveAstarHeap open;
+	open.capacity = 64;
+	open.count = 0;
+	open.nodes = malloc (open.capacity * sizeof (struct ResuelveAstarNode));
+	resuelve_hpa_relax (course, hpa, &open, first, from, 1, -1);
+
+	while (open.count > 0)
+	{
+		struct ResuelveAstarNode top = resuelve_astar_pop (&open);
+		int c = top.index / RESUELVE_HPA_SLOTS;
+		int k = top.index % RESUELVE_HPA_SLOTS;
+		struct ResuelveHpaCluster *cluster = &hpa->clusters[c];
+		struct ResuelveHpaNode *node = &cluster->nodes[k];
+
+		// skip stale entries for entrances already expanded
+		if (node->closed == hpa->search)
+		{
+			continue;
+		}
+		node->closed = hpa->search;
+
+		if (top.index == goal)
+		{
+			length = node->g - 1;
+			break;
+		}
+
+		// other entrances of the same cluster
+		int j;
+		for (j = 0; j < cluster->count; j++)
+		{
+			int distance = cluster->distances[k * cluster->room + j];
+			if (j != k && distance >= 0)
+			{
+				resuelve_hpa_relax (course, hpa, &open, c, j, 
+									node->g + distance, top.index);
+			}
+		}
+
+		// entrances of other clusters just across an edge
+		for (d = 0; d < 4; d++)
+		{
+			int next = node->index + offsets[d];
+			if (course->map[next] == WALL)
+			{
+				continue;
+			}
+			int other = resuelve_hpa_cluster (course, hpa, next);
+			if (other == c)
+			{
+				continue;
+			}
+			for (j = 0; j < hpa->clusters[other].count; j++)
+			{
+				if (hpa->clusters[other].nodes[j].index == next)
+				{
+					resuelve_hpa_relax (course, hpa, &open, other, j, 
+										node->g + 1, top.index);
+					break;
+				}
+			}
+		}
+	}
+
+	// walk back over the entrances, then fill in the moves between each
+	// pair, front to back
+	if (length != RESUELVE_NO_PATH)
+	{
+		int hops = 0;
+		int ref;
+		for (ref = goal; ref >= 0; hops++)
+		{
+			ref = hpa->clusters[ref / RESUELVE_HPA_SLOTS]
+					.nodes[ref % RESUELVE_HPA_SLOTS].parent;
+		}
+		int *path = malloc (hops * sizeof (int));
+		int i = hops;
+		for (ref = goal; ref >= 0; )
+		{
+			path[--i] = ref;
+			ref = hpa->clusters[ref / RESUELVE_HPA_SLOTS]
+					.nodes[ref % RESUELVE_HPA_SLOTS].parent;
+		}
+
+		*route = malloc ((length + 1) * sizeof (int));
+		int filled = 0;
+		for (i = 1; i < hops; i++)
+		{
+			struct ResuelveHpaCluster *cluster = 
+				&hpa->clusters[path[i] / RESUELVE_HPA_SLOTS];
+			int a = hpa->clusters[path[i - 1] / RESUELVE_HPA_SLOTS]
+						.nodes[path[i - 1] % RESUELVE_HPA_SLOTS].index;
+			int b = cluster->nodes[path[i] % RESUELVE_HPA_SLOTS].index;
+			filled += resuelve_hpa_refine (course, hpa, cluster, a, b, 
+											*route + filled);
+		}
+		free (path);
+	}
+
+	// start and finish leave the clusters again
+	hpa->clusters[last].count--;
+	hpa->clusters[first].count--;
+	free (open.nodes);
+
+	return length;
+}
+
+/* calculate a path from start to finish over the clusters of the course
+ * and move the solver along it
+ * returns the number of moves made, or RESUELVE_NO_PATH
+ */
+int resuelve_calculate_path_hpa (struct ResuelveCourse *course,
+									struct ResuelveSolver *solver)
+{
+	return resuelve_solve_route (course, solver, resuelve_hpa_route);
+}
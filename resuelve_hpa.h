@@ -0,0 +1,39 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+/* hierarchical search (HPA*) over very large courses
+ *
+ * the course is cut into square clusters. wherever spaces on both sides of
+ * the edge between two clusters are open, the edge gets an entrance, and
+ * the distances between the entrances of each cluster are measured without
+ * leaving it. a route is found by searching this much smaller graph of
+ * entrances first, and then only the clusters it passes through are
+ * searched again for the spaces in between. routes come out within a few
+ * percent of the shortest, and take time that depends far more on their
+ * length than on the size of the course
+ *
+ * the graph is built when a route is first asked for, or as the course is
+ * loaded if RESUELVE_HPA_GRAPH is defined. a wall that changes only rebuilds
+ * the clusters whose edges it lies on
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+struct ResuelveHpa;
+
+void resuelve_hpa_build (struct ResuelveCourse*);
+void resuelve_hpa_update_cell (struct ResuelveCourse*, int, int);
+void resuelve_hpa_forget (struct ResuelveCourse*);
+int resuelve_hpa_route (struct ResuelveCourse*, int, int, int**);
+int resuelve_calculate_path_hpa (struct ResuelveCourse*, struct ResuelveSolver*);
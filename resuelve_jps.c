@@ -0,0 +1,448 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "limits.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_jps.h"
+#include "resuelve_astar.h"
+#include "resuelve_parse.h"
+#include "resuelve_components.h"
+
+// direction indices, odd ones sideways, and the start, which has none
+#define RESUELVE_JPS_UP 0
+#define RESUELVE_JPS_RIGHT 1
+#define RESUELVE_JPS_DOWN 2
+#define RESUELVE_JPS_LEFT 3
+#define RESUELVE_JPS_START 4
+
+// longest jump a table entry holds
+#define RESUELVE_JPS_LONGEST SCHAR_MAX
+
+static const int resuelve_jps_directions[4] = { UP, RIGHT, DOWN, LEFT };
+static const int resuelve_jps_dx[4] = { 0, 1, 0, -1 };
+static const int resuelve_jps_dy[4] = { -1, 0, 1, 0 };
+static const int resuelve_jps_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+struct ResuelveJpsSearch
+{
+	unsigned char* neighbors;
+	signed char* jumps;
+	int stride;
+	int offsets[4];
+	int finish;
+	int finish_x;
+	int finish_y;
+};
+
+/* return 1 if moving in direction d from cell index onto cell next opens a
+ * way to one side that was walled off beside index, so a shortest route may
+ * have to turn at next
+ */
+static int resuelve_jps_forced (unsigned char *neighbors, int index, int next,
+								int d)
+{
+	int sides = (d & 1) ? (UP_OPEN | DOWN_OPEN) : (LEFT_OPEN | RIGHT_OPEN);
+
+	return (neighbors[next] & ~neighbors[index] & sides) != 0;
+}
+
+/* walk from cell index in direction d to the next jump point: the finish,
+ * a forced turn, or, going up or down, a space from which a sideways walk
+ * finds one
+ * returns the index of the jump point, or -1 if a wall comes first
+ */
+static int resuelve_jps_walk (struct ResuelveJpsSearch *search, int index, 
+								int d)
+{
+	unsigned char *neighbors = search->neighbors;
+	int offset = search->offsets[d];
+
+	while (neighbors[index] & resuelve_jps_open[d])
+	{
+		int next = index + offset;
+		if (next == search->finish 
+			|| resuelve_jps_forced (neighbors, index, next, d))
+		{
+			return next;
+		}
+		if (!(d & 1)
+			&& (resuelve_jps_walk (search, next, RESUELVE_JPS_RIGHT) >= 0
+				|| resuelve_jps_walk (search, next, RESUELVE_JPS_LEFT) >= 0))
+		{
+			return next;
+		}
+		index = next;
+	}
+
+	return -1;
+}
+
+/* return 1 if a walk from cell index in sideways direction d passes at
+ * least distance cells with no wall or jump point, read from the table
+ */
+static int resuelve_jps_clear (struct ResuelveJpsSearch *search, int index,
+								int d, int distance)
+{
+	int jump = search->jumps[4 * index + d];
+
+	while (jump == -RESUELVE_JPS_LONGEST && distance >= RESUELVE_JPS_LONGEST)
+	{
+		index += (RESUELVE_JPS_LONGEST - 1) * search->offsets[d];
+		distance -= RESUELVE_JPS_LONGEST - 1;
+		jump = search->jumps[4 * index + d];
+	}
+
+	return -jump >= distance;
+}
+
+/* read the jump from cell index in direction d out of the table, stopping
+ * short of it where the walk would have found the finish
+ * returns the index of the jump point, or -1 if a wall comes first
+ */
+static int resuelve_jps_lookup (struct ResuelveJpsSearch *search, int index,
+								int d)
+{
+	int x = index % search->stride - 1;
+	int y = index / search->stride - 1;
+	// cells to the finish, or to its row going up or down, 0 or less if it
+	// is not ahead
+	int ahead = (search->finish_y - y) * resuelve_jps_dy[d];
+	if (d & 1)
+	{
+		ahead = y == search->finish_y 
+				? (search->finish_x - x) * resuelve_jps_dx[d] : 0;
+	}
+
+	while (1)
+	{
+		int jump = search->jumps[4 * index + d];
+		int reach = jump > 0 ? jump : -jump;
+		// a jump too long for one entry goes on from the next entry
+		int chained = reach == RESUELVE_JPS_LONGEST;
+		if (chained)
+		{
+			reach = RESUELVE_JPS_LONGEST - 1;
+		}
+
+		if (ahead > 0 && ahead <= reach)
+		{
+			// finish is ahead in this row, no further than the jump reaches
+			if (d & 1)
+			{
+				return search->finish;
+			}
+
+			// finish row is ahead, and a sideways walk along it runs into
+			// the finish before a wall
+			int cross = index + ahead * search->offsets[d];
+			int side = search->finish_x > x 
+						? RESUELVE_JPS_RIGHT : RESUELVE_JPS_LEFT;
+			if (cross == search->finish 
+				|| resuelve_jps_clear (search, cross, side, 
+										abs (search->finish_x - x)))
+			{
+				return cross;
+			}
+		}
+
+		if (!chained)
+		{
+			return jump > 0 ? index + jump * search->offsets[d] : -1;
+		}
+		index += reach * search->offsets[d];
+		ahead -= reach;
+	}
+}
+
+/* work out the up or down jump from cell index in direction d from the
+ * jump out of the next cell, which must already be in the table
+ * the table holds the number of cells to the next jump point if there is
+ * one before a wall, or else minus the number of cells to the wall; either
+ * stops at RESUELVE_JPS_LONGEST, for a jump that goes on from the entry
+ * that many cells less one ahead
+ */
+static void resuelve_jps_chain (signed char *jumps, unsigned char *neighbors, 
+								int index, int offset, int d)
+{
+	int next = index + offset;
+	int ahead = jumps[4 * next + d];
+	signed char *jump = &jumps[4 * index + d];
+
+	if (!(neighbors[index] & resuelve_jps_open[d]))
+	{
+		*jump = 0;
+	}
+	else if (resuelve_jps_forced (neighbors, index, next, d)
+			|| (!(d & 1) && (jumps[4 * next + RESUELVE_JPS_RIGHT] > 0
+							|| jumps[4 * next + RESUELVE_JPS_LEFT] > 0)))
+	{
+		*jump = 1;
+	}
+	else if (ahead > 0)
+	{
+		*jump = ahead < RESUELVE_JPS_LONGEST ? ahead + 1 : RESUELVE_JPS_LONGEST;
+	}
+	else
+	{
+		*jump = ahead > -RESUELVE_JPS_LONGEST 
+				? ahead - 1 : -RESUELVE_JPS_LONGEST;
+	}
+}
+
+/* work out the sideways jumps along one row of count cells, going the way
+ * step points, by carrying each jump back to the cell before it
+ * jumps and neighbors start at the first cell of the row
+ */
+static void resuelve_jps_row (signed char *jumps, unsigned char *neighbors,
+								int count, int step, int open)
+{
+	int x = step > 0 ? count - 1 : 0;
+	int jump = 0;
+
+	for (; x >= 0 && x < count; x -= step)
+	{
+		int here = neighbors[x];
+		if (!(here & open))
+		{
+			jump = 0;
+		}
+		else if (neighbors[x + step] & ~here & (UP_OPEN | DOWN_OPEN))
+		{
+			jump = 1;
+		}
+		else if (jump > 0)
+		{
+			jump += jump < RESUELVE_JPS_LONGEST;
+		}
+		else
+		{
+			jump -= jump > -RESUELVE_JPS_LONGEST;
+		}
+		jumps[4 * x] = jump;
+	}
+}
+
+/* work out the jump from every space of the course in every direction and
+ * keep them with the course, to be read by resuelve_jps_route
+ */
+void resuelve_jps_build_table (struct ResuelveCourse *course)
+{
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int x, y;
+
+	resuelve_load_all_rows (course);
+	unsigned char *neighbors = course->neighbors;
+	free (course->jumps);
+	signed char *jumps = calloc (4 * (long) cells, sizeof (signed char));
+
+	// sideways jumps, working back from the end of each row
+	for (y = 0; y < course->size_y; y++)
+	{
+		int row = RESUELVE_INDEX (course, 0, y);
+		resuelve_jps_row (jumps + 4 * row + RESUELVE_JPS_RIGHT, 
+							neighbors + row, course->size_x, 1, RIGHT_OPEN);
+		resuelve_jps_row (jumps + 4 * row + RESUELVE_JPS_LEFT, 
+							neighbors + row, course->size_x, -1, LEFT_OPEN);
+	}
+
+	// up and down jumps, which need the sideways jumps of the rows they
+	// pass, a row at a time from the end they run toward
+	for (y = 0; y < course->size_y; y++)
+	{
+		int row = RESUELVE_INDEX (course, 0, y);
+		for (x = 0; x < course->size_x; x++)
+		{
+			resuelve_jps_chain (jumps, neighbors, row + x, -stride, 
+								RESUELVE_JPS_UP);
+		}
+	}
+	for (y = course->size_y - 1; y >= 0; y--)
+	{
+		int row = RESUELVE_INDEX (course, 0, y);
+		for (x = 0; x < course->size_x; x++)
+		{
+			resuelve_jps_chain (jumps, neighbors, row + x, stride, 
+								RESUELVE_JPS_DOWN);
+		}
+	}
+
+	course->jumps = jumps;
+}
+
+/* drop the jump table, after the walls change, to be built again when
+ * next asked for
+ */
+void resuelve_jps_forget_table (struct ResuelveCourse *course)
+{
+	free (course->jumps);
+	course->jumps = NULL;
+}
+
+/* find a shortest route from x, y to the finish of the course, searching
+ * only the jump points between them
+ * stores a malloc'd array of directions in route and returns its length,
+ * or RESUELVE_NO_PATH if the finish cannot be reached
+ */
+int resuelve_jps_route (struct ResuelveCourse *course, int x, int y,
+						int **route)
+{
+	struct ResuelveJpsSearch search;
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int length = RESUELVE_NO_PATH;
+	int i;
+
+	*route = NULL;
+
+	// spaces in different components have no way between them
+	if (!resuelve_connected (course, x, y, course->finish_x, course->finish_y))
+	{
+		return RESUELVE_NO_PATH;
+	}
+
+	// jumps run across whole rows and columns
+	resuelve_load_all_rows (course);
+#ifdef RESUELVE_JPS_TABLE
+	if (course->jumps == NULL)
+	{
+		resuelve_jps_build_table (course);
+	}
+#endif
+
+	search.neighbors = course->neighbors;
+	search.jumps = course->jumps;
+	search.stride = stride;
+	search.offsets[RESUELVE_JPS_UP] = -stride;
+	search.offsets[RESUELVE_JPS_RIGHT] = 1;
+	search.offsets[RESUELVE_JPS_DOWN] = stride;
+	search.offsets[RESUELVE_JPS_LEFT] = -1;
+	search.finish = RESUELVE_INDEX (course, course->finish_x, course->finish_y);
+	search.finish_x = course->finish_x;
+	search.finish_y = course->finish_y;
+
+	// cost from start plus one for each jump point, 0 until first reached
+	int *g = calloc (cells, sizeof (int));
+	// jump point each one was jumped to from, and the direction of the jump
+	int *parent = malloc (cells * sizeof (int));
+	unsigned char *from = malloc (cells);
+	unsigned char *closed = calloc (cells, 1);
+
+	struct ResuelveAstarHeap open;
+	open.capacity = 64;
+	open.count = 0;
+	open.nodes = malloc (open.capacity * sizeof (struct ResuelveAstarNode));
+
+	// seed open list with starting cell
+	int start = RESUELVE_INDEX (course, x, y);
+	int h = abs (x - course->finish_x) + abs (y - course->finish_y);
+	g[start] = 1;
+	from[start] = RESUELVE_JPS_START;
+	resuelve_astar_push (&open, h, h, start);
+
+	while (open.count > 0)
+	{
+		struct ResuelveAstarNode node = resuelve_astar_pop (&open);
+
+		// skip stale entries for jump points already expanded
+		if (closed[node.index])
+		{
+			continue;
+		}
+		closed[node.index] = 1;
+
+		// finish reached, so walk back through the jumps, filling in the
+		// cells along each
+		if (node.index == search.finish)
+		{
+			length = g[search.finish] - 1;
+			*route = malloc ((length + 1) * sizeof (int));
+			int cell = search.finish;
+			i = length;
+			while (cell != start)
+			{
+				int d = from[cell];
+				int back = parent[cell];
+				int steps = abs (cell - back) / ((d & 1) ? 1 : stride);
+				while (steps-- > 0)
+				{
+					(*route)[--i] = resuelve_jps_directions[d];
+				}
+				cell = back;
+			}
+			break;
+		}
+
+		// keep going the same way or turn to either side, except from the
+		// start, which may go any way
+		int cx = node.index % stride - 1;
+		int cy = node.index / stride - 1;
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			if (from[node.index] != RESUELVE_JPS_START 
+				&& d == ((from[node.index] + 2) & 3))
+			{
+				continue;
+			}
+
+			int next = search.jumps != NULL
+						? resuelve_jps_lookup (&search, node.index, d)
+						: resuelve_jps_walk (&search, node.index, d);
+			if (next < 0)
+			{
+				continue;
+			}
+
+			// cost of reaching jump point through this one
+			int nx = next % stride - 1;
+			int ny = next / stride - 1;
+			int cost = g[node.index] + abs (nx - cx) + abs (ny - cy);
+			if (closed[next] || (g[next] != 0 && g[next] <= cost))
+			{
+				continue;
+			}
+
+			// found a shorter way to jump point
+			g[next] = cost;
+			parent[next] = node.index;
+			from[next] = d;
+			h = abs (nx - course->finish_x) + abs (ny - course->finish_y);
+			resuelve_astar_push (&open, cost - 1 + h, h, next);
+		}
+	}
+
+	free (open.nodes);
+	free (closed);
+	free (from);
+	free (parent);
+	free (g);
+
+	return length;
+}
+
+/* calculate a shortest path from start to finish with jump point search
+ * and move the solver along it
+ * returns the number of moves made, or RESUELVE_NO_PATH
+ */
+int resuelve_calculate_path_jps (struct ResuelveCourse *course,
+									struct ResuelveSolver *solver)
+{
+	return resuelve_solve_route (course, solver, resuelve_jps_route);
+}
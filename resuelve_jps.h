@@ -0,0 +1,41 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+
+/* jump point search over a loaded course
+ *
+ * a shortest route across open floor can be drawn many ways, and A* tries
+ * all of them; jump point search only stops where a route has to turn, at
+ * spaces beside the end of a wall, and jumps straight over the rest, so it
+ * finds a route just as short while putting far fewer spaces on the open
+ * list
+ *
+ * the jumps can also be worked out once, with resuelve_jps_build_table,
+ * for every space and direction; the search then reads each jump from the
+ * table instead of walking it. the table takes 4 bytes a space, and pays
+ * off on open floors, where jumps are long; among scattered walls jumps
+ * are short, and walking them costs about the same. defining
+ * RESUELVE_JPS_TABLE builds the table as the course is loaded. the table
+ * only follows the walls, so it is kept across moves of the start and
+ * finish that do not replace a wall
+ *
+ * both load every row of a lazily parsed course
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+
+void resuelve_jps_build_table (struct ResuelveCourse*);
+void resuelve_jps_forget_table (struct ResuelveCourse*);
+int resuelve_jps_route (struct ResuelveCourse*, int, int, int**);
+int resuelve_calculate_path_jps (struct ResuelveCourse*, struct ResuelveSolver*);
@@ -0,0 +1,165 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_landmarks.h"
+#include "resuelve_parse.h"
+
+// landmarks picked when no count is given; each takes an int for every cell
+// of the course
+#ifndef RESUELVE_LANDMARKS
+#define RESUELVE_LANDMARKS 8
+#endif
+
+static const int resuelve_landmarks_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+/* find the distance from cell index from to every space that can be reached
+ * from it, storing each one plus one every step ints apart in distances
+ * returns the last space reached, which is one of the farthest
+ */
+static int resuelve_landmarks_spread (struct ResuelveCourse *course, int from,
+										int *distances, int step, int *queue)
+{
+	int stride = course->stride;
+	int offsets[4] = { -stride, 1, stride, -1 };
+	int head = 0;
+	int tail = 0;
+
+	distances[(long) step * from] = 1;
+	queue[tail++] = from;
+	while (head < tail)
+	{
+		int index = queue[head++];
+		int neighbors = course->neighbors[index];
+		int distance = distances[(long) step * index] + 1;
+		int d;
+		for (d = 0; d < 4; d++)
+		{
+			int next = index + offsets[d];
+			if ((neighbors & resuelve_landmarks_open[d])
+				&& distances[(long) step * next] == 0)
+			{
+				distances[(long) step * next] = distance;
+				queue[tail++] = next;
+			}
+		}
+	}
+
+	return queue[tail - 1];
+}
+
+/* pick count landmarks, or RESUELVE_LANDMARKS if count is 0, and keep the
+ * distance from each of them to every space with the course
+ * the first is the space farthest from the start, and each after it the
+ * space farthest from the closest landmark picked so far
+ */
+void resuelve_landmarks_build (struct ResuelveCourse *course, int count)
+{
+	int stride = course->stride;
+	int cells = stride * (course->size_y + 2);
+	int start = RESUELVE_INDEX (course, course->start_x, course->start_y);
+	int used = 0;
+	int i;
+
+	if (count <= 0)
+	{
+		count = RESUELVE_LANDMARKS;
+	}
+
+	resuelve_load_all_rows (course);
+	resuelve_landmarks_forget (course);
+	// distances to the landmarks of each cell are kept together, plus one,
+	// so walls and spaces a landmark cannot reach are left 0
+	int *landmarks = calloc ((long) count * cells, sizeof (int));
+	// distance to the closest landmark so far, plus one
+	int *nearest = calloc (cells, sizeof (int));
+	int *queue = malloc (cells * sizeof (int));
+
+	int landmark = resuelve_landmarks_spread (course, start, nearest, 1, queue);
+	while (used < count)
+	{
+		int *distances = landmarks + used;
+		resuelve_landmarks_spread (course, landmark, distances, count, queue);
+
+		// every landmark reaches the same spaces the start does, so the
+		// distances from the start are only there to pick the first one
+		int farthest = 0;
+		for (i = 0; i < cells; i++)
+		{
+			int distance = distances[(long) count * i];
+			if (used == 0 || distance < nearest[i])
+			{
+				nearest[i] = distance;
+			}
+			if (nearest[i] > farthest)
+			{
+				farthest = nearest[i];
+				landmark = i;
+			}
+		}
+		used++;
+
+		// every space is already a landmark, so the rest are left unused
+		if (farthest <= 1)
+		{
+			break;
+		}
+	}
+
+	free (queue);
+	free (nearest);
+	course->landmarks = landmarks;
+	course->landmark_count = count;
+}
+
+/* drop the landmark distances, after the walls change, to be built again
+ * when next asked for
+ */
+void resuelve_landmarks_forget (struct ResuelveCourse *course)
+{
+	free (course->landmarks);
+	course->landmarks = NULL;
+	course->landmark_count = 0;
+}
+
+/* return a lower bound on the distance between cells index and target, the
+ * largest difference of their distances to a landmark that reaches both
+ */
+int resuelve_landmarks_bound (struct ResuelveCourse *course, int index,
+								int target)
+{
+	int count = course->landmark_count;
+	int *from = course->landmarks + (long) count * index;
+	int *to = course->landmarks + (long) count * target;
+	int bound = 0;
+	int k;
+
+	for (k = 0; k < count; k++)
+	{
+		if (from[k] != 0 && to[k] != 0)
+		{
+			int difference = abs (from[k] - to[k]);
+			if (difference > bound)
+			{
+				bound = difference;
+			}
+		}
+	}
+
+	return bound;
+}
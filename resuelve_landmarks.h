@@ -0,0 +1,36 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* landmark distances, which give A* a closer estimate of the distance left
+ * than counting the rows and columns to the finish
+ *
+ * resuelve_landmarks_build picks spaces far apart from each other and keeps
+ * the distance from each of them to every space. by the triangle
+ * inequality, the distance between two spaces is at least the difference
+ * of their distances to any landmark, which on a maze with long winding
+ * corridors is far more than the rows and columns between them.
+ * resuelve_astar_route uses the larger of the two estimates once the
+ * landmarks are built, and the finish may then move as often as it likes
+ *
+ * landmarks are picked from the start's part of the course, and take an int
+ * for each cell of the course for each landmark. defining
+ * RESUELVE_LANDMARK_TABLE builds them as the course is loaded, and again for
+ * the next route after the walls change. both load every row of a lazily
+ * parsed course
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+
+void resuelve_landmarks_build (struct ResuelveCourse*, int);
+void resuelve_landmarks_forget (struct ResuelveCourse*);
+int resuelve_landmarks_bound (struct ResuelveCourse*, int, int);
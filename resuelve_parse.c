@@ -0,0 +1,704 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+#ifdef __SSE2__
+#include "emmintrin.h"
+#endif
+#ifdef __AVX2__
+#include "immintrin.h"
+#endif
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_parse.h"
+#include "resuelve_binary.h"
+#ifdef RESUELVE_THREADS
+#include "pthread.h"
+#endif
+
+// course files at least this large are mapped and parsed a row at a time as
+// the solver reaches them
+#ifndef RESUELVE_LAZY_BYTES
+#define RESUELVE_LAZY_BYTES (16L << 20)
+#endif
+
+// rows each parsing thread is given at least, and the most threads used,
+// where 0 means one per online processor
+#ifndef RESUELVE_PARSE_ROWS
+#define RESUELVE_PARSE_ROWS 1024
+#endif
+#ifndef RESUELVE_PARSE_THREADS
+#define RESUELVE_PARSE_THREADS 0
+#endif
+
+// start and finish markers found while parsing rows, the last of each wins
+struct ResuelveMarkers
+{
+	int start_x;
+	int start_y;
+	int finish_x;
+	int finish_y;
+	int starts;
+	int finishes;
+};
+
+/* cell value for every byte of a course file, matching the WALL_MARKER,
+ * OPEN_MARKER, START_MARKER and FINISH_MARKER characters
+ * anything else is a wall
+ */
+const unsigned char resuelve_cell_table[256] =
+{
+	['x'] = WALL,
+	['.'] = OPEN,
+	['s'] = START,
+	['f'] = FINISH,
+};
+
+/* map a large course file into memory instead of reading it
+ * returns 1 on success, 0 if the file is small or cannot be mapped
+ */
+static int resuelve_map_course (struct ResuelveCourse *course)
+{
+	int fd = open (course->filename, O_RDONLY);
+	if (fd < 0)
+	{
+		return 0;
+	}
+
+	// only regular files large enough to be worth parsing lazily
+	struct stat info;
+	if (fstat (fd, &info) != 0 || !S_ISREG (info.st_mode)
+		|| info.st_size < RESUELVE_LAZY_BYTES)
+	{
+		close (fd);
+		return 0;
+	}
+
+	void *text = mmap (NULL, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close (fd);
+	if (text == MAP_FAILED)
+	{
+		return 0;
+	}
+
+	course->text = text;
+	course->text_length = info.st_size;
+	course->text_mapped = 1;
+	return 1;
+}
+
+/* read the whole course file into course->text in one pass
+ * returns 1 on success, 0 if the file could not be read
+ */
+int resuelve_read_course (struct ResuelveCourse *course)
+{
+	course->text = NULL;
+	course->text_length = 0;
+	course->text_mapped = 0;
+	course->row_offsets = NULL;
+	course->row_state = NULL;
+
+	if (resuelve_map_course (course))
+	{
+		return 1;
+	}
+
+	// open specified file for reading
+	FILE* file = fopen (course->filename, "rb");
+	if (file == NULL)
+	{
+		printf ("Could not open %s\n", course->filename);
+		return 0;
+	}
+
+	// read file in growing chunks, so pipes work as well as regular files
+	long capacity = 1 << 16;
+	char *text = malloc (capacity);
+	long length = 0;
+	size_t count;
+	while ((count = fread (text + length, 1, capacity - length, file)) > 0)
+	{
+		length += count;
+		if (length == capacity)
+		{
+			capacity *= 2;
+			text = realloc (text, capacity);
+		}
+	}
+
+	// close file
+	fclose (file);
+
+	course->text = text;
+	course->text_length = length;
+	return 1;
+}
+
+/* return length of row y of the course text, not counting the line ending
+ */
+static long resuelve_row_length (struct ResuelveCourse *course, int y)
+{
+	const char *line = course->text + course->row_offsets[y];
+	const char *end = course->text + course->row_offsets[y + 1];
+
+	// ignore line ending, including carriage returns from windows
+	if (end > line && end[-1] == '\n')
+	{
+		end--;
+	}
+	if (end > line && end[-1] == '\r')
+	{
+		end--;
+	}
+
+	return end - line;
+}
+
+/* get the size of the course held in course->text, indexing where each row
+ * of a text course starts on the way
+ * the first element is the width of the widest row and the second element is
+ * the number of rows
+ */
+void resuelve_measure_course (struct ResuelveCourse *course, int *course_size)
+{
+	const char *text = course->text;
+	const char *end = text + course->text_length;
+	const char *line = text;
+	int capacity = 1024;
+	long width = 0;
+	int rows = 0;
+
+	// binary courses keep their size in a header
+	if (resuelve_is_binary_course (course))
+	{
+		resuelve_measure_binary_course (course, course_size);
+		return;
+	}
+
+	free (course->row_offsets);
+	course->row_offsets = malloc (capacity * sizeof (long));
+
+	while (line < end)
+	{
+		// leave room for the offset just past the last row
+		if (rows + 2 > capacity)
+		{
+			capacity *= 2;
+			course->row_offsets = realloc (course->row_offsets,
+											capacity * sizeof (long));
+		}
+		course->row_offsets[rows] = line - text;
+
+		const char *newline = memchr (line, '\n', end - line);
+		line = (newline == NULL) ? end : newline + 1;
+		course->row_offsets[rows + 1] = line - text;
+
+		long length = resuelve_row_length (course, rows);
+		if (length > width)
+		{
+			width = length;
+		}
+		rows++;
+	}
+	course->row_offsets[rows] = course->text_length;
+
+	course_size[0] = width;
+	course_size[1] = rows;
+}
+
+#ifdef __AVX2__
+/* classify 32 bytes of row y of the text at a time into cells
+ * records any start and finish seen in markers, and returns the number of
+ * bytes classified
+ */
+static long resuelve_classify_wide (const unsigned char *text, 
+									RESUELVE_MAP cells, long length, int y,
+									struct ResuelveMarkers *markers)
+{
+	const __m256i open_marker = _mm256_set1_epi8 (OPEN_MARKER[0]);
+	const __m256i start_marker = _mm256_set1_epi8 (START_MARKER[0]);
+	const __m256i finish_marker = _mm256_set1_epi8 (FINISH_MARKER[0]);
+	const __m256i open_cell = _mm256_set1_epi8 (OPEN);
+	const __m256i start_cell = _mm256_set1_epi8 (START);
+	const __m256i finish_cell = _mm256_set1_epi8 (FINISH);
+	long x;
+
+	for (x = 0; x + 32 <= length; x += 32)
+	{
+		__m256i bytes = _mm256_loadu_si256 ((const __m256i *) (text + x));
+		__m256i is_open = _mm256_cmpeq_epi8 (bytes, open_marker);
+		__m256i is_start = _mm256_cmpeq_epi8 (bytes, start_marker);
+		__m256i is_finish = _mm256_cmpeq_epi8 (bytes, finish_marker);
+
+		// each comparison is all ones where it matched, so masking the cell
+		// codes with it leaves walls, and anything unknown, as 0
+		__m256i cell = _mm256_or_si256 (
+							_mm256_and_si256 (is_open, open_cell),
+							_mm256_or_si256 (
+								_mm256_and_si256 (is_start, start_cell),
+								_mm256_and_si256 (is_finish, finish_cell)));
+		_mm256_storeu_si256 ((__m256i *) (cells + x), cell);
+
+		// markers are rare, so one test per block finds them
+		unsigned int found = _mm256_movemask_epi8 (is_start);
+		if (found)
+		{
+			markers->start_x = x + 31 - __builtin_clz (found);
+			markers->start_y = y;
+			markers->starts += __builtin_popcount (found);
+		}
+		found = _mm256_movemask_epi8 (is_finish);
+		if (found)
+		{
+			markers->finish_x = x + 31 - __builtin_clz (found);
+			markers->finish_y = y;
+			markers->finishes += __builtin_popcount (found);
+		}
+	}
+
+	return x;
+}
+#elif defined (__SSE2__)
+/* classify 16 bytes of row y of the text at a time into cells
+ * records any start and finish seen in markers, and returns the number of
+ * bytes classified
+ */
+static long resuelve_classify_wide (const unsigned char *text, 
+									RESUELVE_MAP cells, long length, int y,
+									struct ResuelveMarkers *markers)
+{
+	const __m128i open_marker = _mm_set1_epi8 (OPEN_MARKER[0]);
+	const __m128i start_marker = _mm_set1_epi8 (START_MARKER[0]);
+	const __m128i finish_marker = _mm_set1_epi8 (FINISH_MARKER[0]);
+	const __m128i open_cell = _mm_set1_epi8 (OPEN);
+	const __m128i start_cell = _mm_set1_epi8 (START);
+	const __m128i finish_cell = _mm_set1_epi8 (FINISH);
+	long x;
+
+	for (x = 0; x + 16 <= length; x += 16)
+	{
+		__m128i bytes = _mm_loadu_si128 ((const __m128i *) (text + x));
+		__m128i is_open = _mm_cmpeq_epi8 (bytes, open_marker);
+		__m128i is_start = _mm_cmpeq_epi8 (bytes, start_marker);
+		__m128i is_finish = _mm_cmpeq_epi8 (bytes, finish_marker);
+
+		// each comparison is all ones where it matched, so masking the cell
+		// codes with it leaves walls, and anything unknown, as 0
+		__m128i cell = _mm_or_si128 (_mm_and_si128 (is_open, open_cell),
+							_mm_or_si128 (_mm_and_si128 (is_start, start_cell),
+								_mm_and_si128 (is_finish, finish_cell)));
+		_mm_storeu_si128 ((__m128i *) (cells + x), cell);
+
+		// markers are rare, so one test per block finds them
+		unsigned int found = _mm_movemask_epi8 (is_start);
+		if (found)
+		{
+			markers->start_x = x + 31 - __builtin_clz (found);
+			markers->start_y = y;
+			markers->starts += __builtin_popcount (found);
+		}
+		found = _mm_movemask_epi8 (is_finish);
+		if (found)
+		{
+			markers->finish_x = x + 31 - __builtin_clz (found);
+			markers->finish_y = y;
+			markers->finishes += __builtin_popcount (found);
+		}
+	}
+
+	return x;
+}
+#else
+/* no vector unit, so leave every byte to the table
+ */
+static long resuelve_classify_wide (const unsigned char *text, 
+									RESUELVE_MAP cells, long length, int y,
+									struct ResuelveMarkers *markers)
+{
+	return 0;
+}
+#endif
+
+/* save each cell of row y of the course text in the course map, recording
+ * any start or finish in it in markers
+ */
+static void resuelve_parse_row (struct ResuelveCourse *course, int y, 
+								struct ResuelveMarkers *markers)
+{
+	const unsigned char *row = (const unsigned char *) course->text 
+								+ course->row_offsets[y];
+	long length = resuelve_row_length (course, y);
+	RESUELVE_MAP cells = &RESUELVE_CELL (course, 0, y);
+	long x;
+
+	// classify whole vectors of characters first, then the rest of the row
+	// with one table lookup each
+	for (x = resuelve_classify_wide (row, cells, length, y, markers); 
+			x < length; x++)
+	{
+		cells[x] = resuelve_cell_table[row[x]];
+		if (cells[x] == START)
+		{
+			markers->start_x = x;
+			markers->start_y = y;
+			markers->starts++;
+		}
+		else if (cells[x] == FINISH)
+		{
+			markers->finish_x = x;
+			markers->finish_y = y;
+			markers->finishes++;
+		}
+	}
+}
+
+/* parse rows first through last - 1 of the course text, recording the
+ * markers found in them
+ */
+static void resuelve_parse_rows (struct ResuelveCourse *course, int first,
+									int last, struct ResuelveMarkers *markers)
+{
+	int y;
+
+	markers->starts = 0;
+	markers->finishes = 0;
+	for (y = first; y < last; y++)
+	{
+		resuelve_parse_row (course, y, markers);
+	}
+}
+
+/* save the markers found in the course as its start and finish, warning if
+ * the course has more than one of either, or has none of either
+ */
+static void resuelve_save_markers (struct ResuelveCourse *course,
+									struct ResuelveMarkers *markers)
+{
+	if (markers->starts > 0)
+	{
+		course->start_x = markers->start_x;
+		course->start_y = markers->start_y;
+	}
+	if (markers->finishes > 0)
+	{
+		course->finish_x = markers->finish_x;
+		course->finish_y = markers->finish_y;
+	}
+
+	if (markers->starts > 1)
+	{
+		printf ("Warning: %d starts in course, using %d, %d\n", 
+				markers->starts, course->start_x, course->start_y);
+	}
+	if (markers->finishes > 1)
+	{
+		printf ("Warning: %d finishes in course, using %d, %d\n", 
+				markers->finishes, course->finish_x, course->finish_y);
+	}
+
+	// a course without both cannot be solved, so say which is missing
+	if (markers->starts == 0)
+	{
+		printf ("Course has no start\n");
+	}
+	if (markers->finishes == 0)
+	{
+		printf ("Course has no finish\n");
+	}
+}
+
+#ifdef RESUELVE_THREADS
+/* combine the markers found in a later range of rows into markers
+ */
+static void resuelve_merge_markers (struct ResuelveMarkers *markers,
+									struct ResuelveMarkers *later)
+{
+	if (later->starts > 0)
+	{
+		markers->start_x = later->start_x;
+		markers->start_y = later->start_y;
+		markers->starts += later->starts;
+	}
+	if (later->finishes > 0)
+	{
+		markers->finish_x = later->finish_x;
+		markers->finish_y = later->finish_y;
+		markers->finishes += later->finishes;
+	}
+}
+
+// range of rows parsed by one thread
+struct ResuelveParseJob
+{
+	struct ResuelveCourse *course;
+	int first;
+	int last;
+	struct ResuelveMarkers markers;
+};
+
+/* thread body parsing one range of rows
+ */
+static void *resuelve_parse_job (void *data)
+{
+	struct ResuelveParseJob *job = data;
+
+	resuelve_parse_rows (job->course, job->first, job->last, &job->markers);
+
+	return NULL;
+}
+
+/* number of threads to share work among, from setting, where 0 means one
+ * per online processor, but no more than most and at least one
+ */
+int resuelve_thread_count (int setting, int most)
+{
+	int threads = setting;
+	if (threads <= 0)
+	{
+		threads = sysconf (_SC_NPROCESSORS_ONLN);
+	}
+
+	// small amounts of work are not worth starting threads for
+	if (threads > most)
+	{
+		threads = most;
+	}
+
+	return threads < 1 ? 1 : threads;
+}
+
+/* run job on each of the count jobs of size bytes at jobs, each on its own
+ * thread, and wait until they have all finished
+ * a job that no thread could be started for is run here instead
+ */
+void resuelve_run_threads (void *(*job) (void*), void *jobs, int count, 
+							size_t size)
+{
+	pthread_t *ids = malloc (count * sizeof (pthread_t));
+	int i;
+
+	for (i = 0; i < count; i++)
+	{
+		void *data = (char*) jobs + i * size;
+		if (pthread_create (&ids[i], NULL, job, data) != 0)
+		{
+			ids[i] = pthread_self ();
+			job (data);
+		}
+	}
+	for (i = 0; i < count; i++)
+	{
+		if (!pthread_equal (ids[i], pthread_self ()))
+		{
+			pthread_join (ids[i], NULL);
+		}
+	}
+
+	free (ids);
+}
+#endif
+
+/* parse every row of the course text, splitting the rows of large courses
+ * into ranges parsed on their own threads
+ * rows only write their own cells, so the ranges need no locking
+ */
+static void resuelve_parse_all_rows (struct ResuelveCourse *course,
+										struct ResuelveMarkers *markers)
+{
+#ifdef RESUELVE_THREADS
+	int threads = resuelve_thread_count (RESUELVE_PARSE_THREADS, 
+								course->size_y / RESUELVE_PARSE_ROWS);
+	if (threads > 1)
+	{
+		struct ResuelveParseJob *jobs = 
+			malloc (threads * sizeof (struct ResuelveParseJob));
+		int i;
+
+		for (i = 0; i < threads; i++)
+		{
+			jobs[i].course = course;
+			jobs[i].first = (long) course->size_y * i / threads;
+			jobs[i].last = (long) course->size_y * (i + 1) / threads;
+		}
+		resuelve_run_threads (resuelve_parse_job, jobs, threads, 
+								sizeof (struct ResuelveParseJob));
+
+		// merge in row order, so later markers win as they do in one pass
+		markers->starts = 0;
+		markers->finishes = 0;
+		for (i = 0; i < threads; i++)
+		{
+			resuelve_merge_markers (markers, &jobs[i].markers);
+		}
+
+		free (jobs);
+		return;
+	}
+#endif
+
+	resuelve_parse_rows (course, 0, course->size_y, markers);
+}
+
+/* find the last occurrence of marker in the course text and save its
+ * coordinates, without parsing any rows
+ * returns the number of times marker occurs
+ */
+static int resuelve_find_marker (struct ResuelveCourse *course, char marker,
+									int *marker_x, int *marker_y)
+{
+	const char *text = course->text;
+	const char *end = text + course->text_length;
+	const char *found = NULL;
+	const char *next = text;
+	int count = 0;
+
+	while ((next = memchr (next, marker, end - next)) != NULL)
+	{
+		found = next++;
+		count++;
+	}
+	if (found == NULL)
+	{
+		return 0;
+	}
+
+	// binary search row index for the row holding the marker
+	long offset = found - text;
+	int low = 0;
+	int high = course->size_y - 1;
+	while (low < high)
+	{
+		int middle = (low + high + 1) / 2;
+		if (course->row_offsets[middle] <= offset)
+		{
+			low = middle;
+		}
+		else
+		{
+			high = middle - 1;
+		}
+	}
+
+	*marker_x = offset - course->row_offsets[low];
+	*marker_y = low;
+
+	return count;
+}
+
+/* save course text, or a binary course, in the course map, which must
+ * already be allocated for the measured size
+ * mapped courses only have their start and finish located here, and each
+ * row is parsed by resuelve_load_row the first time it is reached
+ */
+void resuelve_parse_course (struct ResuelveCourse *course)
+{
+	struct ResuelveMarkers markers;
+
+	// binary courses expand quickly enough to always load up front
+	if (resuelve_is_binary_course (course))
+	{
+		resuelve_parse_binary_course (course);
+		return;
+	}
+
+	if (course->text_mapped)
+	{
+		// border rows are walls and never need loading
+		course->row_state = calloc (course->size_y + 2, 1);
+		course->row_state[0] = RESUELVE_ROW_READY;
+		course->row_state[course->size_y + 1] = RESUELVE_ROW_READY;
+		course->rows_parsed = 0;
+
+		markers.starts = resuelve_find_marker (course, START_MARKER[0], 
+								&markers.start_x, &markers.start_y);
+		markers.finishes = resuelve_find_marker (course, FINISH_MARKER[0], 
+								&markers.finish_x, &markers.finish_y);
+		resuelve_save_markers (course, &markers);
+		return;
+	}
+
+	resuelve_parse_all_rows (course, &markers);
+	resuelve_save_markers (course, &markers);
+}
+
+/* load row y of a lazily parsed course, parsing it and the rows next to it
+ * and building its neighbor masks
+ * always returns 1, so it can end a RESUELVE_TOUCH_ROW test
+ */
+int resuelve_load_row (struct ResuelveCourse *course, int y)
+{
+	struct ResuelveMarkers markers = { 0, 0, 0, 0, 0, 0 };
+	int row;
+
+	// neighbor masks need the cells above and below as well
+	for (row = y - 1; row <= y + 1; row++)
+	{
+		if (course->row_state[row + 1] == RESUELVE_ROW_EMPTY)
+		{
+			// markers were already located when the course was mapped
+			resuelve_parse_row (course, row, &markers);
+			course->row_state[row + 1] = RESUELVE_ROW_PARSED;
+			course->rows_parsed++;
+		}
+	}
+
+	resuelve_build_row_neighbors (course, y);
+	course->row_state[y + 1] = RESUELVE_ROW_READY;
+
+	// text is no longer needed once every row has been parsed
+	if (course->rows_parsed == course->size_y && course->text != NULL)
+	{
+		resuelve_release_course_text (course);
+	}
+
+	return 1;
+}
+
+/* load every row of a lazily parsed course
+ */
+void resuelve_load_all_rows (struct ResuelveCourse *course)
+{
+	int y;
+
+	for (y = 0; y < course->size_y; y++)
+	{
+		RESUELVE_TOUCH_ROW (course, y);
+	}
+}
+
+/* free the text read by resuelve_read_course and its row index
+ */
+void resuelve_release_course_text (struct ResuelveCourse *course)
+{
+	if (course->text_mapped)
+	{
+		munmap (course->text, course->text_length);
+	}
+	else
+	{
+		free (course->text);
+	}
+	free (course->row_offsets);
+
+	course->text = NULL;
+	course->text_length = 0;
+	course->text_mapped = 0;
+	course->row_offsets = NULL;
+}
@@ -0,0 +1,38 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* course file reading and parsing shared by resuelve.c and resuelve_create.c
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+
+// load state of each row of a lazily parsed course
+#define RESUELVE_ROW_EMPTY 0
+#define RESUELVE_ROW_PARSED 1
+#define RESUELVE_ROW_READY 2
+
+// make sure row y and its neighbor masks are loaded before they are used
+// courses parsed up front have no row state and are always loaded
+#define RESUELVE_TOUCH_ROW(course, y) \
+	((void) ((course)->row_state == NULL \
+		|| (course)->row_state[(y) + 1] == RESUELVE_ROW_READY \
+		|| resuelve_load_row (course, y)))
+
+extern const unsigned char resuelve_cell_table[256];
+
+int resuelve_read_course (struct ResuelveCourse*);
+void resuelve_measure_course (struct ResuelveCourse*, int *course_size);
+void resuelve_parse_course (struct ResuelveCourse*);
+int resuelve_load_row (struct ResuelveCourse*, int);
+void resuelve_load_all_rows (struct ResuelveCourse*);
+void resuelve_release_course_text (struct ResuelveCourse*);
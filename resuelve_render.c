@@ -0,0 +1,240 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#ifndef RESUELVE_CREATE
+#include "unistd.h"
+#include "sys/ioctl.h"
+#endif
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_render.h"
+#include "resuelve_parse.h"
+
+// lines printed under the course between frames, which must also fit on
+// the terminal for the course to stay in place
+#define RESUELVE_RENDER_STATUS_LINES 4
+
+/* character shown for each kind of cell, matching the markers
+ * unknown cells are not shown
+ */
+const char resuelve_marker_table[256] =
+{
+	[WALL] = 'x',
+	[OPEN] = '.',
+	[START] = 's',
+	[FINISH] = 'f',
+	[PATH] = 't',
+	[VISITED] = 'o',
+};
+
+/* make room for at least size more bytes after length in the frame buffer
+ */
+static void resuelve_render_reserve (struct ResuelveCourse *course, 
+										long length, long size)
+{
+	if (length + size <= course->frame_capacity)
+	{
+		return;
+	}
+
+	long capacity = course->frame_capacity > 0 ? course->frame_capacity : 4096;
+	while (capacity < length + size)
+	{
+		capacity *= 2;
+	}
+	course->frame = realloc (course->frame, capacity);
+	course->frame_capacity = capacity;
+}
+
+/* append every row of map, laid out like the course map, to the frame buffer
+ * returns the new length of the frame
+ */
+static long resuelve_render_full (struct ResuelveCourse *course, 
+									RESUELVE_MAP map, long length)
+{
+	int x, y;
+
+	resuelve_render_reserve (course, length, 
+								(long) course->size_y * (course->size_x + 1));
+	char *out = course->frame + length;
+	for (y = 0; y < course->size_y; y++)
+	{
+		const unsigned char *row = map + RESUELVE_INDEX (course, 0, y);
+		for (x = 0; x < course->size_x; x++)
+		{
+			char marker = resuelve_marker_table[row[x]];
+			if (marker != 0)
+			{
+				*out++ = marker;
+			}
+		}
+		*out++ = '\n';
+	}
+
+	return out - course->frame;
+}
+
+/* write the first length bytes of the frame buffer to standard output
+ */
+static void resuelve_render_write (struct ResuelveCourse *course, long length)
+{
+#ifdef RESUELVE_CREATE
+	// the controller console only has printf
+	resuelve_render_reserve (course, length, 1);
+	course->frame[length] = '\0';
+	printf ("%s", course->frame);
+#else
+	// anything already printed has to come out before the frame
+	fflush (stdout);
+
+	const char *out = course->frame;
+	while (length > 0)
+	{
+		ssize_t written = write (STDOUT_FILENO, out, length);
+		if (written <= 0)
+		{
+			break;
+		}
+		out += written;
+		length -= written;
+	}
+#endif
+}
+
+#ifndef RESUELVE_CREATE
+/* return 1 if standard output is a terminal the whole course fits on, along
+ * with the lines printed under it
+ */
+static int resuelve_render_fits (struct ResuelveCourse *course)
+{
+	struct winsize size;
+	const char *term = getenv ("TERM");
+
+	if (!isatty (STDOUT_FILENO) || term == NULL || strcmp (term, "dumb") == 0
+		|| ioctl (STDOUT_FILENO, TIOCGWINSZ, &size) != 0)
+	{
+		return 0;
+	}
+
+	return course->size_x <= size.ws_col
+		&& course->size_y + RESUELVE_RENDER_STATUS_LINES <= size.ws_row;
+}
+
+/* append the cursor movement and markers for every cell of map that changed
+ * since the last frame, updating the saved frame as it goes
+ * returns the new length of the frame
+ */
+static long resuelve_render_changes (struct ResuelveCourse *course, 
+										RESUELVE_MAP map, long length)
+{
+	int x, y;
+
+	for (y = 0; y < course->size_y; y++)
+	{
+		unsigned char *row = map + RESUELVE_INDEX (course, 0, y);
+		unsigned char *shown = course->shown + RESUELVE_INDEX (course, 0, y);
+
+		// most rows are unchanged between steps
+		if (memcmp (row, shown, course->size_x) == 0)
+		{
+			continue;
+		}
+
+		for (x = 0; x < course->size_x; x++)
+		{
+			if (row[x] == shown[x])
+			{
+				continue;
+			}
+
+			// one cursor move for each run of changed cells
+			resuelve_render_reserve (course, length, 32);
+			length += sprintf (course->frame + length, "\033[%d;%dH", 
+								y + 1, x + 1);
+			while (x < course->size_x && row[x] != shown[x])
+			{
+				resuelve_render_reserve (course, length, 1);
+				course->frame[length++] = resuelve_marker_table[row[x]];
+				shown[x] = row[x];
+				x++;
+			}
+		}
+	}
+
+	// leave the cursor under the course for anything printed next
+	resuelve_render_reserve (course, length, 32);
+	length += sprintf (course->frame + length, "\033[%d;1H\033[J", 
+						course->size_y + 2);
+
+	return length;
+}
+#endif
+
+/* display the course, redrawing only what changed since the last frame when
+ * standard output is a terminal the course fits on
+ */
+void resuelve_render_course (struct ResuelveCourse *course)
+{
+	// the whole course is shown, so parse any rows not reached yet
+	resuelve_load_all_rows (course);
+
+	resuelve_render_map (course, course->map);
+}
+
+/* display map, laid out like the course map and fully loaded, in place of
+ * the course
+ */
+void resuelve_render_map (struct ResuelveCourse *course, RESUELVE_MAP map)
+{
+	long length = 0;
+
+#ifndef RESUELVE_CREATE
+	if (resuelve_render_fits (course))
+	{
+		if (course->shown != NULL)
+		{
+			length = resuelve_render_changes (course, map, length);
+			resuelve_render_write (course, length);
+			return;
+		}
+
+		// first frame clears the screen and draws the course at the top
+		int cells = course->stride * (course->size_y + 2);
+		course->shown = malloc (cells);
+		memcpy (course->shown, map, cells);
+
+		resuelve_render_reserve (course, length, 16);
+		length += sprintf (course->frame + length, "\033[H\033[2J");
+		length = resuelve_render_full (course, map, length);
+		resuelve_render_reserve (course, length, 1);
+		course->frame[length++] = '\n';
+		resuelve_render_write (course, length);
+		return;
+	}
+#endif
+
+	length = resuelve_render_full (course, map, length);
+	resuelve_render_write (course, length);
+}
+
+/* forget the last frame, so the next one redraws the whole course
+ */
+void resuelve_render_reset (struct ResuelveCourse *course)
+{
+	free (course->shown);
+	course->shown = NULL;
+}
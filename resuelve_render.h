@@ -0,0 +1,27 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* course display shared by resuelve.c and resuelve_create.c
+ *
+ * each frame is built in one buffer and written at once; on a terminal large
+ * enough to hold the course, frames after the first only redraw the cells
+ * that changed, using ANSI cursor positioning
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+
+extern const char resuelve_marker_table[256];
+
+void resuelve_render_course (struct ResuelveCourse*);
+void resuelve_render_map (struct ResuelveCourse*, unsigned char*);
+void resuelve_render_reset (struct ResuelveCourse*);
@@ -0,0 +1,65 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_reset.h"
+
+/* list cell x, y as marked by the solver, before it is first marked
+ */
+void resuelve_track_cell (struct ResuelveCourse *course, int x, int y)
+{
+	// grow list if full
+	if (course->touched_count == course->touched_capacity)
+	{
+		course->touched_capacity = course->touched_capacity 
+									? course->touched_capacity * 2 : 64;
+		course->touched = realloc (course->touched, 
+								course->touched_capacity * sizeof (int));
+	}
+	course->touched[course->touched_count++] = RESUELVE_INDEX (course, x, y);
+}
+
+/* put every cell marked since the last reset back to the space it was,
+ * start and finish included, and refresh the neighbor masks around it
+ */
+void resuelve_reset_course (struct ResuelveCourse *course)
+{
+	int start = RESUELVE_INDEX (course, course->start_x, course->start_y);
+	int finish = RESUELVE_INDEX (course, course->finish_x, course->finish_y);
+	int stride = course->stride;
+	int i;
+
+	for (i = 0; i < course->touched_count; i++)
+	{
+		int index = course->touched[i];
+		if (index == start)
+		{
+			course->map[index] = START;
+		}
+		else if (index == finish)
+		{
+			course->map[index] = FINISH;
+		}
+		else
+		{
+			course->map[index] = OPEN;
+		}
+		resuelve_update_neighbors (course, index % stride - 1, 
+									index / stride - 1);
+	}
+	course->touched_count = 0;
+}
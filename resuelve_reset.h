@@ -0,0 +1,26 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* undo what a solve wrote into a course, so it can be solved again without
+ * loading it again
+ *
+ * every cell a solver marks as its path or visited is a space it found
+ * open, and is listed the first time it is marked; resetting puts back
+ * only the listed cells, so it costs as much as the solve explored rather
+ * than the size of the course
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+
+void resuelve_track_cell (struct ResuelveCourse*, int, int);
+void resuelve_reset_course (struct ResuelveCourse*);
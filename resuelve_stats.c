@@ -0,0 +1,58 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "string.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+
+#ifdef RESUELVE_STATS
+/* clear all of the solver's counters
+ */
+void resuelve_stats_clear (struct ResuelveSolver *solver)
+{
+	memset (&solver->stats, 0, sizeof (solver->stats));
+}
+
+/* clear the solver's counters for a new solve, keeping the load time
+ */
+void resuelve_stats_solve (struct ResuelveSolver *solver)
+{
+	double load_ms = solver->stats.load_ms;
+
+	memset (&solver->stats, 0, sizeof (solver->stats));
+	solver->stats.load_ms = load_ms;
+}
+#endif
+
+/* print the solver's counters as one JSON object
+ */
+void resuelve_print_stats (struct ResuelveSolver *solver)
+{
+#ifdef RESUELVE_STATS
+	struct ResuelveStats *stats = &solver->stats;
+
+	printf ("{\"load_ms\": %.3f, \"solve_ms\": %.3f, \"display_ms\": %.3f, "
+			"\"check_obstacle\": %ld, \"check_wall\": %ld, "
+			"\"check_visited\": %ld, \"moves\": %ld, \"revisits\": %ld, "
+			"\"fallbacks\": %ld, \"turns\": %ld, \"drives\": %ld}\n",
+			stats->load_ms, stats->solve_ms, stats->display_ms,
+			stats->check_obstacle, stats->check_wall, stats->check_visited,
+			stats->moves, stats->revisits, stats->fallbacks, stats->turns,
+			stats->drives);
+#else
+	(void) solver;
+	printf ("{}\n");
+#endif
+}
@@ -0,0 +1,80 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* solver statistics, counted only when RESUELVE_STATS is defined
+ *
+ * included by resuelve.h and resuelve_create.h, since the solver carries
+ * the counters, so include one of those instead
+ *
+ * without RESUELVE_STATS the counting macros expand to nothing and the
+ * solver carries no counters; resuelve_print_stats then prints an empty
+ * object
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveSolver;
+
+#ifdef RESUELVE_STATS
+
+struct ResuelveStats
+{
+	// tests for a wall or visited space, for a wall, and for a visited
+	// space, made by the check functions or on the neighbor masks
+	long check_obstacle;
+	long check_wall;
+	long check_visited;
+	// calls to resuelve_move, and moves into an already visited space
+	long moves;
+	long revisits;
+	// times the greedy solver was blocked in on all four sides
+	long fallbacks;
+	// turns and drive commands
+	long turns;
+	long drives;
+	// time spent in each phase, in milliseconds, where a solve includes the
+	// time it spends displaying the course
+	double load_ms;
+	double solve_ms;
+	double display_ms;
+};
+
+// count one event
+#define RESUELVE_STAT(solver, counter) ((solver)->stats.counter++)
+// count one event and give the result of test, for tests made in place of
+// a check function
+#define RESUELVE_STAT_TEST(solver, counter, test) \
+	(RESUELVE_STAT (solver, counter), (test))
+// start and stop a phase timer, which adds up the time between the two
+#define RESUELVE_STAT_START(solver, timer) \
+	((solver)->stats.timer -= resuelve_clock () * 1000.0)
+#define RESUELVE_STAT_STOP(solver, timer) \
+	((solver)->stats.timer += resuelve_clock () * 1000.0)
+// clear every counter, or everything counted by the last solve, keeping
+// the load time
+#define RESUELVE_STAT_CLEAR(solver) resuelve_stats_clear (solver)
+#define RESUELVE_STAT_SOLVE(solver) resuelve_stats_solve (solver)
+
+void resuelve_stats_clear (struct ResuelveSolver*);
+void resuelve_stats_solve (struct ResuelveSolver*);
+
+#else
+
+#define RESUELVE_STAT(solver, counter) ((void) 0)
+#define RESUELVE_STAT_TEST(solver, counter, test) (test)
+#define RESUELVE_STAT_START(solver, timer) ((void) 0)
+#define RESUELVE_STAT_STOP(solver, timer) ((void) 0)
+#define RESUELVE_STAT_CLEAR(solver) ((void) 0)
+#define RESUELVE_STAT_SOLVE(solver) ((void) 0)
+
+#endif
+
+void resuelve_print_stats (struct ResuelveSolver*);
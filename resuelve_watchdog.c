@@ -0,0 +1,124 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_watchdog.h"
+#include "resuelve_astar.h"
+
+/* start watching for a new cycle from the solver's next state
+ */
+static void resuelve_watchdog_restart (struct ResuelveWatchdog *watchdog,
+										struct ResuelveSolver *solver)
+{
+	watchdog->explored = solver->explored;
+	// no real state, so the first one checked is saved instead of matched
+	watchdog->saved_x = -1;
+	watchdog->saved_y = -1;
+	watchdog->saved_angle = -1;
+	watchdog->power = 1;
+	watchdog->length = 1;
+}
+
+/* start watching a solve with the solver's budgets
+ */
+void resuelve_watchdog_start (struct ResuelveWatchdog *watchdog, 
+								struct ResuelveSolver *solver)
+{
+	watchdog->deadline = solver->time_limit > 0 
+							? resuelve_clock () + solver->time_limit : 0;
+	watchdog->checks = 0;
+	resuelve_watchdog_restart (watchdog, solver);
+}
+
+/* check the solver once per step of its solve
+ * returns 0 to carry on, RESUELVE_STEP_LIMIT or RESUELVE_TIME_LIMIT once a
+ * budget is used up, or RESUELVE_STALLED if the solver is going in circles
+ */
+int resuelve_watchdog_check (struct ResuelveWatchdog *watchdog, 
+								struct ResuelveSolver *solver)
+{
+	if (solver->step_limit > 0 && solver->steps >= solver->step_limit)
+	{
+		printf ("Step limit reached\n");
+		return RESUELVE_STEP_LIMIT;
+	}
+	if (watchdog->deadline > 0 
+		&& ++watchdog->checks % RESUELVE_WATCHDOG_CLOCK_CHECKS == 0
+		&& resuelve_clock () >= watchdog->deadline)
+	{
+		printf ("Time limit reached\n");
+		return RESUELVE_TIME_LIMIT;
+	}
+
+	// entering a new space changes the course, so any cycle starts over
+	if (solver->explored != watchdog->explored)
+	{
+		resuelve_watchdog_restart (watchdog, solver);
+	}
+
+	if (solver->x == watchdog->saved_x && solver->y == watchdog->saved_y
+		&& solver->angle == watchdog->saved_angle)
+	{
+		printf ("Stalled at %d, %d\n", solver->x, solver->y);
+		return RESUELVE_STALLED;
+	}
+
+	// move the saved state up to the solver each time the search length
+	// reaches the next power of two
+	if (watchdog->power == watchdog->length)
+	{
+		watchdog->saved_x = solver->x;
+		watchdog->saved_y = solver->y;
+		watchdog->saved_angle = solver->angle;
+		watchdog->power *= 2;
+		watchdog->length = 0;
+	}
+	watchdog->length++;
+
+	return 0;
+}
+
+/* move a stalled solver the rest of the way to the finish along a shortest
+ * route, if there is one within its step budget
+ * the search itself is bounded by the size of the course, so it is not cut
+ * short by the time budget
+ * returns 0 once the finish is reached, RESUELVE_NO_PATH or
+ * RESUELVE_STEP_LIMIT
+ */
+int resuelve_watchdog_recover (struct ResuelveCourse *course, 
+								struct ResuelveSolver *solver)
+{
+	int *route;
+	int length = resuelve_astar_route (course, solver->x, solver->y, &route);
+
+	if (length == RESUELVE_NO_PATH)
+	{
+		printf ("No path\n");
+		return RESUELVE_NO_PATH;
+	}
+	if (solver->step_limit > 0 && solver->steps + length > solver->step_limit)
+	{
+		printf ("Step limit reached\n");
+		free (route);
+		return RESUELVE_STEP_LIMIT;
+	}
+
+	resuelve_follow_route (course, solver, route, length);
+	free (route);
+
+	return 0;
+}
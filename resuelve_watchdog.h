@@ -0,0 +1,46 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* step and time budgets for the greedy solver, and detection of a solver
+ * going around in circles
+ *
+ * while the solver enters no new space the course does not change, so its
+ * next move depends only on where it is; coming back to the same position
+ * and angle then means it will loop forever, which is found with Brent's
+ * cycle detection in constant memory
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+struct ResuelveSolver;
+
+// how many checks pass between looks at the clock
+#define RESUELVE_WATCHDOG_CLOCK_CHECKS 256
+
+struct ResuelveWatchdog
+{
+	// time the solve must end by, or 0 for no limit
+	double deadline;
+	long checks;
+	// spaces the solver had entered when the watch for a cycle began
+	int explored;
+	// state the solver is compared against, and the cycle search lengths
+	int saved_x;
+	int saved_y;
+	int saved_angle;
+	long power;
+	long length;
+};
+
+void resuelve_watchdog_start (struct ResuelveWatchdog*, struct ResuelveSolver*);
+int resuelve_watchdog_check (struct ResuelveWatchdog*, struct ResuelveSolver*);
+int resuelve_watchdog_recover (struct ResuelveCourse*, struct ResuelveSolver*);
@@ -0,0 +1,700 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+#include "stdio.h"
+#include "stdlib.h"
+#include "string.h"
+#include "stdint.h"
+#include "limits.h"
+
+#ifdef RESUELVE_CREATE
+#include "resuelve_create.h"
+#else
+#include "resuelve.h"
+#endif
+#include "resuelve_wavefront.h"
+#include "resuelve_parse.h"
+#ifdef RESUELVE_THREADS
+#include "pthread.h"
+#endif
+
+// the frontier is spread bottom up, over every row, once it holds at least
+// this fraction of the words of the course
+#ifndef RESUELVE_WAVEFRONT_BOTTOM_UP
+#define RESUELVE_WAVEFRONT_BOTTOM_UP 16
+#endif
+
+// courses with at least this many cells are searched with a pool of
+// threads, at most this many, where 0 means one per online processor;
+// frontiers spread top down are only shared among the threads once they
+// hold this many words
+#ifndef RESUELVE_WAVEFRONT_SHARED_CELLS
+#define RESUELVE_WAVEFRONT_SHARED_CELLS (1L << 22)
+#endif
+#ifndef RESUELVE_WAVEFRONT_THREADS
+#define RESUELVE_WAVEFRONT_THREADS 0
+#endif
+#ifndef RESUELVE_WAVEFRONT_SHARED
+#define RESUELVE_WAVEFRONT_SHARED 2048
+#endif
+
+// directions in the order neighbors are tried when tracing a route
+static const int resuelve_wavefront_directions[4] = { UP, RIGHT, DOWN, LEFT };
+static const int resuelve_wavefront_open[4] = 
+	{ UP_OPEN, RIGHT_OPEN, DOWN_OPEN, LEFT_OPEN };
+
+struct ResuelveWavefront
+{
+	// words from one bit row to the next; rows are laid out like the course
+	// map, with an empty row above and below the course and an empty word
+	// at each end of every row
+	int span;
+	// cells the finish can be reached from
+	uint64_t* reached;
+	// distance to the finish modulo 3 of each reached cell: 1 sets a bit in
+	// ones, 2 a bit in twos, and 0 neither
+	uint64_t* ones;
+	uint64_t* twos;
+};
+
+/* pack the spaces of row y of the course into bits, 64 cells to a word
+ */
+static void resuelve_wavefront_pack (struct ResuelveCourse *course, int y,
+										uint64_t *bits)
+{
+	const unsigned char *row = &RESUELVE_CELL (course, 0, y);
+	int x, b;
+
+	// whole words first, in a loop the compiler can vectorize
+	for (x = 0; x + 64 <= course->size_x; x += 64)
+	{
+		uint64_t word = 0;
+		for (b = 0; b < 64; b++)
+		{
+			word |= (uint64_t) (row[x + b] != WALL) << b;
+		}
+		bits[x / 64] = word;
+	}
+	for (; x < course->size_x; x++)
+	{
+		bits[x / 64] |= (uint64_t) (row[x] != WALL) << (x % 64);
+	}
+}
+
+/* one search in progress, shared by the threads spreading it
+ */
+struct ResuelveWavefrontSearch
+{
+	struct ResuelveCourse *course;
+	int span;
+	long bit_rows;
+	uint64_t *open;
+	uint64_t *seen;
+	uint64_t *ones;
+	uint64_t *twos;
+	// cells reached on the last level, and on the level being spread
+	uint64_t *front;
+	uint64_t *next;
+	// words holding the frontier, words spread into on this level, and
+	// words of the new frontier
+	long *frontier;
+	long frontier_count;
+	long *expand;
+	long expand_count;
+	long *grown;
+	long grown_count;
+	// distance modulo 3 of the level being spread
+	int level;
+	// threads sharing the search
+	int threads;
+#ifdef RESUELVE_THREADS
+	// pass each thread takes part in, and the barriers around it
+	void (*pass) (struct ResuelveWavefrontSearch*, int, int);
+	int stop;
+	pthread_mutex_t gate;
+	pthread_barrier_t start;
+	pthread_barrier_t done;
+#endif
+};
+
+// words a thread lists before adding them to a shared list
+#define RESUELVE_WAVEFRONT_BATCH 256
+
+struct ResuelveWavefrontBatch
+{
+	long *list;
+	long *count;
+	long words[RESUELVE_WAVEFRONT_BATCH];
+	int used;
+};
+
+/* add the words in batch to the end of its shared list
+ */
+static void resuelve_wavefront_flush (struct ResuelveWavefrontBatch *batch)
+{
+#ifdef RESUELVE_THREADS
+	long at = __atomic_fetch_add (batch->count, batch->used, __ATOMIC_RELAXED);
+#else
+	long at = *batch->count;
+	*batch->count += batch->used;
+#endif
+	memcpy (batch->list + at, batch->words, batch->used * sizeof (long));
+	batch->used = 0;
+}
+
+/* list word k in batch
+ */
+static void resuelve_wavefront_list (struct ResuelveWavefrontBatch *batch,
+										long k)
+{
+	batch->words[batch->used++] = k;
+	if (batch->used == RESUELVE_WAVEFRONT_BATCH)
+	{
+		resuelve_wavefront_flush (batch);
+	}
+}
+
+/* add bits to word k of next, listing k if nothing was added to it before
+ * on this level
+ * threads may add to the same word at once when shared is set
+ */
+static void resuelve_wavefront_spread (struct ResuelveWavefrontSearch *search,
+										struct ResuelveWavefrontBatch *batch,
+										long k, uint64_t bits, int shared)
+{
+	uint64_t before;
+
+	if (bits == 0)
+	{
+		return;
+	}
+#ifdef RESUELVE_THREADS
+	if (shared)
+	{
+		before = __atomic_fetch_or (&search->next[k], bits, __ATOMIC_RELAXED);
+	}
+	else
+#else
+	(void) shared;
+#endif
+	{
+		before = search->next[k];
+		search->next[k] |= bits;
+	}
+	if (before == 0)
+	{
+		resuelve_wavefront_list (batch, k);
+	}
+}
+
+/* save the cells of word k of next as reached at the current level
+ */
+static void resuelve_wavefront_settle (struct ResuelveWavefrontSearch *search,
+										long k)
+{
+	uint64_t bits = search->next[k];
+
+	search->seen[k] |= bits;
+	if (search->level == 1)
+	{
+		search->ones[k] |= bits;
+	}
+	else if (search->level == 2)
+	{
+		search->twos[k] |= bits;
+	}
+}
+
+/* pack this thread's share of the course rows into bits
+ */
+static void resuelve_wavefront_pack_pass (
+								struct ResuelveWavefrontSearch *search, 
+								int thread, int threads)
+{
+	int rows = search->course->size_y;
+	int y;
+
+	for (y = (long) rows * thread / threads; 
+			y < (long) rows * (thread + 1) / threads; y++)
+	{
+		resuelve_wavefront_pack (search->course, y, 
+									search->open + (y + 1) * search->span + 1);
+	}
+}
+
+/* top down: spread this thread's share of the frontier words into the
+ * words around them; bits move up a place into the cell to the right and
+ * down a place into the cell to the left, carrying across words, and the
+ * empty words around the course keep every neighbor in the bit rows
+ */
+static void resuelve_wavefront_push_pass (
+								struct ResuelveWavefrontSearch *search,
+								int thread, int threads)
+{
+	struct ResuelveWavefrontBatch batch;
+	long count = search->frontier_count;
+	long span = search->span;
+	long i;
+
+	batch.list = search->expand;
+	batch.count = &search->expand_count;
+	batch.used = 0;
+	for (i = count * thread / threads; i < count * (thread + 1) / threads; 
+			i++)
+	{
+		long k = search->frontier[i];
+		uint64_t bits = search->front[k];
+		search->front[k] = 0;
+		resuelve_wavefront_spread (search, &batch, k, bits << 1 | bits >> 1,
+									threads > 1);
+		resuelve_wavefront_spread (search, &batch, k - 1, bits << 63, 
+									threads > 1);
+		resuelve_wavefront_spread (search, &batch, k + 1, bits >> 63, 
+									threads > 1);
+		resuelve_wavefront_spread (search, &batch, k - span, bits, 
+									threads > 1);
+		resuelve_wavefront_spread (search, &batch, k + span, bits, 
+									threads > 1);
+	}
+	resuelve_wavefront_flush (&batch);
+}
+
+/* top down: keep only spaces not reached yet in this thread's share of the
+ * words spread into, settling the rest as the new frontier
+ */
+static void resuelve_wavefront_keep_pass (
+								struct ResuelveWavefrontSearch *search,
+								int thread, int threads)
+{
+	struct ResuelveWavefrontBatch batch;
+	long count = search->expand_count;
+	long i;
+
+	batch.list = search->grown;
+	batch.count = &search->grown_count;
+	batch.used = 0;
+	for (i = count * thread / threads; i < count * (thread + 1) / threads; 
+			i++)
+	{
+		long k = search->expand[i];
+		search->next[k] &= search->open[k] & ~search->seen[k];
+		if (search->next[k] != 0)
+		{
+			resuelve_wavefront_settle (search, k);
+			resuelve_wavefront_list (&batch, k);
+		}
+	}
+	resuelve_wavefront_flush (&batch);
+}
+
+/* bottom up: for every word in this thread's share of the rows with spaces
+ * not reached yet, gather the frontier around it
+ */
+static void resuelve_wavefront_pull_pass (
+								struct ResuelveWavefrontSearch *search,
+								int thread, int threads)
+{
+	const uint64_t *front = search->front;
+	long span = search->span;
+	int rows = search->course->size_y;
+	long k;
+
+	for (k = (1 + (long) rows * thread / threads) * span; 
+			k < (1 + (long) rows * (thread + 1) / threads) * span; k++)
+	{
+		uint64_t unseen = search->open[k] & ~search->seen[k];
+		if (unseen != 0)
+		{
+			search->next[k] = (front[k] << 1 | front[k - 1] >> 63 
+								| front[k] >> 1 | front[k + 1] << 63 
+								| front[k - span] | front[k + span]) & unseen;
+		}
+	}
+}
+
+/* bottom up: clear the frontier from this thread's share of the rows, and
+ * settle the words gathered into as the new frontier
+ */
+static void resuelve_wavefront_gather_pass (
+								struct ResuelveWavefrontSearch *search,
+								int thread, int threads)
+{
+	struct ResuelveWavefrontBatch batch;
+	long span = search->span;
+	int rows = search->course->size_y;
+	long k;
+
+	batch.list = search->grown;
+	batch.count = &search->grown_count;
+	batch.used = 0;
+	for (k = (1 + (long) rows * thread / threads) * span; 
+			k < (1 + (long) rows * (thread + 1) / threads) * span; k++)
+	{
+		search->front[k] = 0;
+		if (search->next[k] != 0)
+		{
+			resuelve_wavefront_settle (search, k);
+			resuelve_wavefront_list (&batch, k);
+		}
+	}
+	resuelve_wavefront_flush (&batch);
+}
+
+/* add bits to word k of next, listing k in expand if nothing was added to
+ * it before on this level
+ */
+static void resuelve_wavefront_add (uint64_t *next, long *expand, long *count, 
+									long k, uint64_t bits)
+{
+	if (bits == 0)
+	{
+		return;
+	}
+	if (next[k] == 0)
+	{
+		expand[(*count)++] = k;
+	}
+	next[k] |= bits;
+}
+
+/* top down on one thread: spread the frontier words into the words around
+ * them, then keep only spaces not reached yet as the new frontier
+ * this is the same as the push and keep passes, with the lists written
+ * directly, since mazes spend most of their search on narrow frontiers
+ */
+static void resuelve_wavefront_spread_alone (
+								struct ResuelveWavefrontSearch *search)
+{
+	uint64_t *next = search->next;
+	long span = search->span;
+	long count = 0;
+	long i;
+
+	for (i = 0; i < search->frontier_count; i++)
+	{
+		long k = search->frontier[i];
+		uint64_t bits = search->front[k];
+		search->front[k] = 0;
+		resuelve_wavefront_add (next, search->expand, &count, k, 
+								bits << 1 | bits >> 1);
+		resuelve_wavefront_add (next, search->expand, &count, k - 1, 
+								bits << 63);
+		resuelve_wavefront_add (next, search->expand, &count, k + 1, 
+								bits >> 63);
+		resuelve_wavefront_add (next, search->expand, &count, k - span, bits);
+		resuelve_wavefront_add (next, search->expand, &count, k + span, bits);
+	}
+
+	search->grown_count = 0;
+	for (i = 0; i < count; i++)
+	{
+		long k = search->expand[i];
+		next[k] &= search->open[k] & ~search->seen[k];
+		if (next[k] != 0)
+		{
+			resuelve_wavefront_settle (search, k);
+			search->grown[search->grown_count++] = k;
+		}
+	}
+}
+
+#ifdef RESUELVE_THREADS
+struct ResuelveWavefrontThread
+{
+	struct ResuelveWavefrontSearch *search;
+	int thread;
+};
+
+/* thread body taking part in every pass handed out until told to stop
+ */
+static void *resuelve_wavefront_worker (void *data)
+{
+	struct ResuelveWavefrontThread *worker = data;
+	struct ResuelveWavefrontSearch *search = worker->search;
+
+	// wait until every thread has started and the barriers are ready
+	pthread_mutex_lock (&search->gate);
+	pthread_mutex_unlock (&search->gate);
+
+	while (1)
+	{
+		pthread_barrier_wait (&search->start);
+		if (search->stop)
+		{
+			break;
+		}
+		search->pass (search, worker->thread, search->threads);
+		pthread_barrier_wait (&search->done);
+	}
+
+	return NULL;
+}
+#endif
+
+/* run pass over the whole search, shared among the threads if there are
+ * any
+ */
+static void resuelve_wavefront_run (struct ResuelveWavefrontSearch *search,
+						void (*pass) (struct ResuelveWavefrontSearch*, int, int))
+{
+#ifdef RESUELVE_THREADS
+	if (search->threads > 1)
+	{
+		search->pass = pass;
+		pthread_barrier_wait (&search->start);
+		pass (search, 0, search->threads);
+		pthread_barrier_wait (&search->done);
+		return;
+	}
+#endif
+	pass (search, 0, 1);
+}
+
+/* search out from the finish over every space of the course, and keep
+ * which cells were reached and their distances modulo 3 with the course
+ * each level is spread top down from the frontier while it is small, and
+ * bottom up over every row once it is large; on large courses the rows,
+ * or the frontier, are shared among threads
+ * every row is loaded first
+ */
+void resuelve_wavefront_measure (struct ResuelveCourse *course)
+{
+	struct ResuelveWavefrontSearch search;
+
+	resuelve_load_all_rows (course);
+	resuelve_wavefront_forget (course);
+
+	search.course = course;
+	search.span = (course->size_x + 63) / 64 + 2;
+	search.bit_rows = (long) (course->size_y + 2) * search.span;
+	search.open = calloc (search.bit_rows, sizeof (uint64_t));
+	search.seen = calloc (search.bit_rows, sizeof (uint64_t));
+	search.ones = calloc (search.bit_rows, sizeof (uint64_t));
+	search.twos = calloc (search.bit_rows, sizeof (uint64_t));
+	search.front = calloc (search.bit_rows, sizeof (uint64_t));
+	search.next = calloc (search.bit_rows, sizeof (uint64_t));
+	search.frontier = malloc (search.bit_rows * sizeof (long));
+	search.expand = malloc (search.bit_rows * sizeof (long));
+	search.grown = malloc (search.bit_rows * sizeof (long));
+	search.expand_count = 0;
+	search.grown_count = 0;
+	search.threads = 1;
+
+#ifdef RESUELVE_THREADS
+	// small courses are not worth starting threads for
+	int threads = resuelve_thread_count (RESUELVE_WAVEFRONT_THREADS,
+						(long) course->size_x * course->size_y 
+							< RESUELVE_WAVEFRONT_SHARED_CELLS ? 1 : INT_MAX);
+	struct ResuelveWavefrontThread *workers = 
+		malloc (threads * sizeof (struct ResuelveWavefrontThread));
+	pthread_t *ids = malloc (threads * sizeof (pthread_t));
+	int i;
+
+	// the barriers count every thread, so they are made once it is known
+	// how many started, before the threads are let through the gate
+	search.stop = 0;
+	pthread_mutex_init (&search.gate, NULL);
+	pthread_mutex_lock (&search.gate);
+	for (i = 1; i < threads; i++)
+	{
+		workers[i].search = &search;
+		workers[i].thread = i;
+		if (pthread_create (&ids[i], NULL, resuelve_wavefront_worker, 
+							&workers[i]) != 0)
+		{
+			break;
+		}
+		search.threads++;
+	}
+	pthread_barrier_init (&search.start, NULL, search.threads);
+	pthread_barrier_init (&search.done, NULL, search.threads);
+	pthread_mutex_unlock (&search.gate);
+#endif
+
+	resuelve_wavefront_run (&search, resuelve_wavefront_pack_pass);
+
+	// the search starts from the finish alone, at distance 0
+	long k = (course->finish_y + 1) * (long) search.span 
+				+ course->finish_x / 64 + 1;
+	search.front[k] = (uint64_t) 1 << (course->finish_x % 64);
+	search.seen[k] = search.front[k];
+	search.frontier[0] = k;
+	search.frontier_count = 1;
+	search.level = 0;
+
+	while (search.frontier_count > 0)
+	{
+		search.level = (search.level + 1) % 3;
+		search.grown_count = 0;
+
+		if (search.frontier_count 
+				>= search.bit_rows / RESUELVE_WAVEFRONT_BOTTOM_UP)
+		{
+			resuelve_wavefront_run (&search, resuelve_wavefront_pull_pass);
+			resuelve_wavefront_run (&search, resuelve_wavefront_gather_pass);
+		}
+		else if (search.threads > 1 
+					&& search.frontier_count >= RESUELVE_WAVEFRONT_SHARED)
+		{
+			search.expand_count = 0;
+			resuelve_wavefront_run (&search, resuelve_wavefront_push_pass);
+			resuelve_wavefront_run (&search, resuelve_wavefront_keep_pass);
+		}
+		else
+		{
+			resuelve_wavefront_spread_alone (&search);
+		}
+
+		// the new frontier becomes the one to spread next, and the cleared
+		// frontier takes the next level
+		uint64_t *swap_bits = search.front;
+		search.front = search.next;
+		search.next = swap_bits;
+		long *swap_words = search.frontier;
+		search.frontier = search.grown;
+		search.grown = swap_words;
+		search.frontier_count = search.grown_count;
+	}
+
+#ifdef RESUELVE_THREADS
+	// let the threads go
+	search.stop = 1;
+	if (search.threads > 1)
+	{
+		pthread_barrier_wait (&search.start);
+	}
+	for (i = 1; i < search.threads; i++)
+	{
+		pthread_join (ids[i], NULL);
+	}
+	pthread_barrier_destroy (&search.start);
+	pthread_barrier_destroy (&search.done);
+	pthread_mutex_destroy (&search.gate);
+	free (ids);
+	free (workers);
+#endif
+
+	free (search.grown);
+	free (search.expand);
+	free (search.frontier);
+	free (search.next);
+	free (search.front);
+	free (search.open);
+
+	struct ResuelveWavefront *wavefront = malloc (sizeof (*wavefront));
+	wavefront->span = search.span;
+	wavefront->reached = search.seen;
+	wavefront->ones = search.ones;
+	wavefront->twos = search.twos;
+	course->wavefront = wavefront;
+}
+
+/* drop the search, after the finish or the walls change
+ */
+void resuelve_wavefront_forget (struct ResuelveCourse *course)
+{
+	if (course->wavefront == NULL)
+	{
+		return;
+	}
+	free (course->wavefront->reached);
+	free (course->wavefront->ones);
+	free (course->wavefront->twos);
+	free (course->wavefront);
+	course->wavefront = NULL;
+}
+
+/* return the distance modulo 3 of cell x, y, or -1 if it was not reached
+ */
+static int resuelve_wavefront_level (struct ResuelveWavefront *wavefront, 
+										int x, int y)
+{
+	long k = (y + 1) * (long) wavefront->span + x / 64 + 1;
+	uint64_t bit = (uint64_t) 1 << (x % 64);
+
+	if (!(wavefront->reached[k] & bit))
+	{
+		return -1;
+	}
+	return ((wavefront->ones[k] & bit) ? 1 : 0) 
+			+ ((wavefront->twos[k] & bit) ? 2 : 0);
+}
+
+/* return 1 if the finish can be reached from x, y, 0 if not, searching
+ * first if the course has not been searched
+ */
+int resuelve_wavefront_reachable (struct ResuelveCourse *course, int x, int y)
+{
+	if (course->wavefront == NULL)
+	{
+		resuelve_wavefront_measure (course);
+	}
+	return resuelve_wavefront_level (course->wavefront, x, y) >= 0;
+}
+
+/* step from x, y to the neighbor one closer to the finish, storing the
+ * direction taken in direction
+ */
+static void resuelve_wavefront_step (struct ResuelveCourse *course, int *x,
+										int *y, int *direction)
+{
+	static const int dx[4] = { 0, 1, 0, -1 };
+	static const int dy[4] = { -1, 0, 1, 0 };
+	int closer = (resuelve_wavefront_level (course->wavefront, *x, *y) + 2) 
+					% 3;
+	int neighbors = RESUELVE_NEIGHBORS (course, *x, *y);
+	int d;
+
+	for (d = 0; d < 4; d++)
+	{
+		if ((neighbors & resuelve_wavefront_open[d])
+			&& resuelve_wavefront_level (course->wavefront, *x + dx[d], 
+											*y + dy[d]) == closer)
+		{
+			break;
+		}
+	}
+	*x += dx[d];
+	*y += dy[d];
+	*direction = resuelve_wavefront_directions[d];
+}
+
+/* find a shortest route from x, y to the finish of the course by tracing
+ * the search back, searching first if the course has not been searched
+ * stores a malloc'd array of directions in route and returns its length,
+ * or RESUELVE_NO_PATH if the finish cannot be reached
+ */
+int resuelve_wavefront_route (struct ResuelveCourse *course, int x, int y,
+								int **route)
+{
+	int length = 0;
+	int cx, cy, direction, i;
+
+	*route = NULL;
+	if (!resuelve_wavefront_reachable (course, x, y))
+	{
+		return RESUELVE_NO_PATH;
+	}
+
+	// only distances modulo 3 are kept, so trace once to find the length
+	// and again to save the directions
+	for (cx = x, cy = y; cx != course->finish_x || cy != course->finish_y; 
+			length++)
+	{
+		resuelve_wavefront_step (course, &cx, &cy, &direction);
+	}
+	*route = malloc ((length + 1) * sizeof (int));
+	for (i = 0, cx = x, cy = y; i < length; i++)
+	{
+		resuelve_wavefront_step (course, &cx, &cy, &(*route)[i]);
+	}
+
+	return length;
+}
@@ -0,0 +1,39 @@
+/*
+ * Tommy MacWilliam, 2009
+ * Malden Catholic High School Robotics
+ *
+ * Resuelve is licensed under the 
+ * Creative Commons Attribution-Share Alike 3.0 United States.
+ * For more information, see http://creativecommons.org/licenses/by-sa/3.0/us/
+ *
+ */
+
+/* breadth first search out from the finish of a whole course, a level at a
+ * time over bit rows
+ *
+ * the spaces, the cells already reached and the frontier are each kept as
+ * rows of 64 bit words, one bit per cell, so a level is spread with shifts,
+ * ORs and masks a word at a time; while the frontier is small only the
+ * words around it are spread, and once it is large every row gathers from
+ * it instead
+ *
+ * on courses of RESUELVE_WAVEFRONT_SHARED_CELLS or more the rows, or a
+ * large frontier, are split among a pool of threads that wait at a barrier
+ * between passes; narrow frontiers, as in mazes, are still spread on one
+ * thread, since a barrier costs more than the level
+ *
+ * the distance of each reached cell is kept modulo 3 in two more bit
+ * planes; the distances of neighbors differ by at most one, so that is
+ * enough to tell which neighbor is closer to the finish when tracing a
+ * route back
+ *
+ * build this file with RESUELVE_CREATE defined when linking against
+ * resuelve_create.c
+ */
+
+struct ResuelveCourse;
+
+void resuelve_wavefront_measure (struct ResuelveCourse*);
+void resuelve_wavefront_forget (struct ResuelveCourse*);
+int resuelve_wavefront_reachable (struct ResuelveCourse*, int, int);
+int resuelve_wavefront_route (struct ResuelveCourse*, int, int, int**);